@@ -0,0 +1,323 @@
+#include "analytics.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <bitset>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+using Bitmap = std::unique_ptr<std::atomic<uint64_t>[]>;
+
+static const auto MaxExploreCells = 40u;
+static const auto ExploreChunkWords = 1u << 12;
+static const auto SampleChunk = 1u << 10;
+
+static uint32_t popCount(uint64_t value) {
+
+	return static_cast<uint32_t>(std::bitset<64>(value).count());
+}
+
+static uint32_t lowestBitIndex(uint64_t value) {
+
+	assert(value != 0);
+	static const uint32_t DeBruijnIndex[64] = {
+		0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+		62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+		63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+		46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+	};
+	return DeBruijnIndex[((value & (~value + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+}
+
+static bool getBit(const std::vector<uint64_t>& bits, uint32_t index) {
+
+	return (bits[index / 64] >> (index % 64)) & 1u;
+}
+
+static void setBit(std::vector<uint64_t>& bits, uint32_t index) {
+
+	bits[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+static void xorBits(std::vector<uint64_t>& dst, const std::vector<uint64_t>& src) {
+
+	for (size_t i = 0; i < dst.size(); ++i)
+		dst[i] ^= src[i];
+}
+
+static uint32_t popCount(const std::vector<uint64_t>& bits) {
+
+	auto count = 0u;
+	for (auto word : bits)
+		count += popCount(word);
+	return count;
+}
+
+MovesSolver::MovesSolver(uint32_t size) :
+	size_(size),
+	cells_(size * size) {
+
+	assert(size > 0);
+	assert(size <= Board::MaxSize);
+
+	const auto words = (cells_ + 63) / 64;
+	// equation per knob: the moves sharing its row or column flip it
+	std::vector<Bits> rows(cells_, Bits(words));
+	transform_.assign(cells_, Bits(words));
+	for (auto cell = 0u; cell < cells_; ++cell) {
+		for (auto i = 0u; i < size_; ++i) {
+			setBit(rows[cell], (cell / size_) * size_ + i);
+			setBit(rows[cell], i * size_ + cell % size_);
+		}
+		setBit(transform_[cell], cell);
+	}
+	// Gauss-Jordan elimination, transform_ accumulates the row operations
+	std::vector<uint32_t> freeColumns;
+	for (auto column = 0u; column < cells_; ++column) {
+		auto pivot = rank_;
+		while (pivot < cells_ && !getBit(rows[pivot], column))
+			++pivot;
+		if (pivot == cells_) {
+			freeColumns.push_back(column);
+			continue;
+		}
+		std::swap(rows[pivot], rows[rank_]);
+		std::swap(transform_[pivot], transform_[rank_]);
+		for (auto row = 0u; row < cells_; ++row) {
+			if (row != rank_ && getBit(rows[row], column)) {
+				xorBits(rows[row], rows[rank_]);
+				xorBits(transform_[row], transform_[rank_]);
+			}
+		}
+		pivots_.push_back(column);
+		++rank_;
+	}
+	// every free column gives one move set which changes nothing
+	for (auto column : freeColumns) {
+		Bits moves(words);
+		setBit(moves, column);
+		for (auto row = 0u; row < rank_; ++row) {
+			if (getBit(rows[row], column))
+				setBit(moves, pivots_[row]);
+		}
+		kernel_.push_back(std::move(moves));
+	}
+}
+
+bool MovesSolver::solve(const Board& board, uint32_t& length) const {
+
+	assert(board.getSize() == size_);
+
+	Bits target((cells_ + 63) / 64);
+	for (auto y = 0u; y < size_; ++y) {
+		for (auto x = 0u; x < size_; ++x) {
+			if (!board.isChecked(x, y))
+				setBit(target, y * size_ + x);
+		}
+	}
+	Bits moves(target.size());
+	for (auto row = 0u; row < cells_; ++row) {
+		auto value = 0u;
+		for (size_t i = 0; i < target.size(); ++i)
+			value ^= popCount(transform_[row][i] & target[i]) & 1u;
+		if (value && row >= rank_)
+			return false;
+		if (value)
+			setBit(moves, pivots_[row]);
+	}
+
+	// any kernel combination solves the board as well, look for the shortest
+	length = popCount(moves);
+	if (isExact()) {
+		for (uint64_t i = 1; i < (uint64_t(1) << kernel_.size()); ++i) {
+			xorBits(moves, kernel_[lowestBitIndex(i)]);
+			length = std::min(length, popCount(moves));
+		}
+		return true;
+	}
+	for (auto improved = true; improved;) {
+		improved = false;
+		for (const auto& vector : kernel_) {
+			xorBits(moves, vector);
+			auto count = popCount(moves);
+			if (count < length) {
+				length = count;
+				improved = true;
+			} else {
+				xorBits(moves, vector);
+			}
+		}
+	}
+	return true;
+}
+
+uint64_t getExploreMemory(uint32_t size) {
+
+	const auto cells = size * size;
+	if (cells > MaxExploreCells)
+		return std::numeric_limits<uint64_t>::max();
+	const auto words = std::max<uint64_t>((uint64_t(1) << cells) / 64, 1);
+	return 3 * words * sizeof(uint64_t);
+}
+
+static std::vector<Board::Row> decodeState(uint64_t state, uint32_t size) {
+
+	std::vector<Board::Row> rows(size);
+	for (auto y = 0u; y < size; ++y)
+		rows[y] = (state >> (y * size)) & ((Board::Row(1) << size) - 1);
+	return rows;
+}
+
+Difficulty exploreDifficulty(uint32_t size, uint32_t worstCount, ThreadPool& pool) {
+
+	const auto cells = size * size;
+	assert(cells <= MaxExploreCells);
+
+	const auto wordsCount = std::max<uint64_t>((uint64_t(1) << cells) / 64, 1);
+	const auto fullRow = (uint64_t(1) << size) - 1;
+	const auto solved = (uint64_t(1) << cells) - 1;
+
+	// state bit y * size + x holds knob (x, y), a move flips its cross
+	std::vector<uint64_t> crosses;
+	for (auto y = 0u; y < size; ++y) {
+		for (auto x = 0u; x < size; ++x) {
+			auto cross = fullRow << (y * size);
+			for (auto i = 0u; i < size; ++i)
+				cross |= uint64_t(1) << (i * size + x);
+			crosses.push_back(cross);
+		}
+	}
+	auto isValid = [size, fullRow](uint64_t state) {
+		auto unlocked = fullRow;
+		for (auto y = 0u; y < size; ++y)
+			unlocked &= state >> (y * size);
+		return (unlocked & fullRow) == 0;
+	};
+
+	Bitmap visited(new std::atomic<uint64_t>[wordsCount]());
+	Bitmap frontier(new std::atomic<uint64_t>[wordsCount]());
+	Bitmap next(new std::atomic<uint64_t>[wordsCount]());
+	visited[solved / 64] = uint64_t(1) << (solved % 64);
+	frontier[solved / 64] = uint64_t(1) << (solved % 64);
+
+	Difficulty result;
+	result.size = size;
+	result.rank = MovesSolver(size).getRank();
+	result.exact = true;
+
+	std::mutex mutex;
+	for (auto length = 0u;; ++length) {
+		// frontier holds states at the current distance from the solved board
+		std::atomic<uint64_t> statesCount{0};
+		std::atomic<uint64_t> boardsCount{0};
+		std::vector<uint64_t> worst;
+		for (uint64_t start = 0; start < wordsCount; start += ExploreChunkWords) {
+			pool.submit([&, start]() {
+				auto states = uint64_t(0);
+				auto boards = uint64_t(0);
+				std::vector<uint64_t> found;
+				const auto end = std::min<uint64_t>(start + ExploreChunkWords, wordsCount);
+				for (auto i = start; i < end; ++i) {
+					auto word = frontier[i].load(std::memory_order_relaxed);
+					states += popCount(word);
+					for (; word != 0; word &= word - 1) {
+						const auto state = i * 64 + lowestBitIndex(word);
+						if (isValid(state)) {
+							++boards;
+							if (found.size() < worstCount)
+								found.push_back(state);
+						}
+						for (auto cross : crosses) {
+							const auto target = state ^ cross;
+							const auto mask = uint64_t(1) << (target % 64);
+							if (!(visited[target / 64].fetch_or(mask) & mask))
+								next[target / 64].fetch_or(mask, std::memory_order_relaxed);
+						}
+					}
+				}
+				statesCount += states;
+				boardsCount += boards;
+				std::lock_guard<std::mutex> lock(mutex);
+				worst.insert(worst.end(), found.begin(), found.end());
+			});
+		}
+		pool.wait();
+
+		if (statesCount == 0)
+			break;
+		result.states.push_back(statesCount);
+		result.boards.push_back(boardsCount);
+		if (boardsCount > 0) {
+			std::sort(worst.begin(), worst.end());
+			worst.resize(std::min<size_t>(worst.size(), worstCount));
+			result.worstLength = length;
+			result.worstBoards.clear();
+			for (auto state : worst)
+				result.worstBoards.push_back(decodeState(state, size));
+		}
+		std::swap(frontier, next);
+		for (uint64_t i = 0; i < wordsCount; ++i)
+			next[i].store(0, std::memory_order_relaxed);
+	}
+	return result;
+}
+
+Difficulty sampleDifficulty(uint32_t size, uint64_t samples, uint64_t seed,
+	uint32_t worstCount, ThreadPool& pool) {
+
+	const MovesSolver solver(size);
+
+	Difficulty result;
+	result.size = size;
+	result.rank = solver.getRank();
+	result.exact = false;
+	result.lengthsExact = solver.isExact();
+
+	std::mutex mutex;
+	for (uint64_t start = 0; start < samples; start += SampleChunk) {
+		pool.submit([&, start]() {
+			Board board;
+			std::vector<uint64_t> boards;
+			std::vector<uint64_t> worstSeeds;
+			auto worstLength = 0u;
+			const auto end = std::min<uint64_t>(start + SampleChunk, samples);
+			for (auto i = start; i < end; ++i) {
+				board.generate(size, seed + i);
+				auto length = 0u;
+				if (!solver.solve(board, length)) {
+					assert(!"generated board can't be solved");
+					continue;
+				}
+				if (boards.size() <= length)
+					boards.resize(length + 1);
+				++boards[length];
+				if (length > worstLength) {
+					worstLength = length;
+					worstSeeds.clear();
+				}
+				if (length == worstLength && worstSeeds.size() < worstCount)
+					worstSeeds.push_back(seed + i);
+			}
+			std::lock_guard<std::mutex> lock(mutex);
+			if (result.boards.size() < boards.size())
+				result.boards.resize(boards.size());
+			for (size_t i = 0; i < boards.size(); ++i)
+				result.boards[i] += boards[i];
+			if (worstLength > result.worstLength) {
+				result.worstLength = worstLength;
+				result.worstSeeds.clear();
+			}
+			if (worstLength == result.worstLength)
+				result.worstSeeds.insert(result.worstSeeds.end(), worstSeeds.begin(), worstSeeds.end());
+		});
+	}
+	pool.wait();
+
+	// every chunk keeps its smallest seeds, so the result doesn't depend on timing
+	std::sort(result.worstSeeds.begin(), result.worstSeeds.end());
+	result.worstSeeds.resize(std::min<size_t>(result.worstSeeds.size(), worstCount));
+	for (auto worstSeed : result.worstSeeds)
+		result.worstBoards.push_back(Board(size, worstSeed).getRows());
+	return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "board.h"
+#include "threadpool.h"
+#include <stdint.h>
+#include <vector>
+
+// Difficulty of the boards of one size, counted by minimum solution length.
+struct Difficulty {
+
+	uint32_t size = 0;
+	uint32_t rank = 0;
+	bool exact = false;
+	// false when lengths are only upper bounds of the minimum
+	bool lengthsExact = true;
+	// length histograms: every solvable board (exact only) and valid starting boards
+	std::vector<uint64_t> states;
+	std::vector<uint64_t> boards;
+	uint32_t worstLength = 0;
+	std::vector<std::vector<Board::Row>> worstBoards;
+	std::vector<uint64_t> worstSeeds;
+};
+
+// Solves boards over GF(2): a board is a set of knobs to flip and every move
+// flips a fixed cross of knobs, so solutions are x with A * x = b.
+class MovesSolver {
+
+public:
+	static const auto MaxExactKernelDim = 16u;
+
+	explicit MovesSolver(uint32_t size);
+
+	uint32_t getRank() const { return rank_; }
+	uint32_t getKernelDim() const { return static_cast<uint32_t>(kernel_.size()); }
+	bool isExact() const { return kernel_.size() <= MaxExactKernelDim; }
+	// Minimum moves count solving the board, an upper bound when the kernel
+	// is too large to enumerate. False when the board can't be solved.
+	bool solve(const Board& board, uint32_t& length) const;
+
+private:
+	using Bits = std::vector<uint64_t>;
+
+	uint32_t size_ = 0;
+	uint32_t cells_ = 0;
+	uint32_t rank_ = 0;
+	std::vector<Bits> transform_;
+	std::vector<uint32_t> pivots_;
+	std::vector<Bits> kernel_;
+};
+
+// Bytes needed by exploreDifficulty for boards of the given size.
+uint64_t getExploreMemory(uint32_t size);
+// Breadth-first search over every state reachable from the solved board.
+Difficulty exploreDifficulty(uint32_t size, uint32_t worstCount, ThreadPool& pool);
+// Solves uniformly generated boards with seeds [seed, seed + samples).
+Difficulty sampleDifficulty(uint32_t size, uint64_t samples, uint64_t seed,
+	uint32_t worstCount, ThreadPool& pool);
@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Board difficulty analytics
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = analytics
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    analyticsmain.cpp \
+    analytics.cpp \
+    threadpool.cpp \
+    board.cpp
+
+HEADERS += \
+    analytics.h \
+    threadpool.h \
+    board.h \
+    rng.h
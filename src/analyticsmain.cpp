@@ -0,0 +1,83 @@
+#include "analytics.h"
+#include <cstdio>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+static void printDifficulty(const Difficulty& difficulty) {
+
+	const auto size = difficulty.size;
+	printf("size %u: moves rank %u of %u, %s\n", size, difficulty.rank, size * size,
+		difficulty.exact ? "all boards" : "sampled boards");
+	if (!difficulty.lengthsExact)
+		printf("lengths are upper bounds, too many equivalent solutions to check\n");
+	printf("%8s %16s %16s\n", "length", "boards", difficulty.exact ? "solvable states" : "");
+	for (size_t i = 0; i < difficulty.boards.size(); ++i) {
+		if (difficulty.exact) {
+			printf("%8zu %16llu %16llu\n", i, (unsigned long long)difficulty.boards[i],
+				(unsigned long long)difficulty.states[i]);
+		} else if (difficulty.boards[i] > 0) {
+			printf("%8zu %16llu\n", i, (unsigned long long)difficulty.boards[i]);
+		}
+	}
+	printf("worst length %u%s\n", difficulty.worstLength,
+		difficulty.lengthsExact ? "" : " (upper bound)");
+	for (size_t i = 0; i < difficulty.worstBoards.size(); ++i) {
+		if (i < difficulty.worstSeeds.size())
+			printf("seed %llu\n", (unsigned long long)difficulty.worstSeeds[i]);
+		for (auto row : difficulty.worstBoards[i]) {
+			for (auto x = 0u; x < size; ++x)
+				putchar(((row >> x) & 1u) ? '#' : '.');
+			putchar('\n');
+		}
+		putchar('\n');
+	}
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Board difficulty distributions per size");
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Worker threads count (0 = all cores).", "count", "0");
+    QCommandLineOption memoryOption("memory", "Memory limit of the full search in MiB.", "mib", "1024");
+    QCommandLineOption samplesOption("samples", "Boards sampled when the full search doesn't fit.", "count", "100000");
+    QCommandLineOption seedOption("seed", "First seed of sampled boards.", "seed", "0");
+    QCommandLineOption worstOption("worst", "Worst boards printed per size.", "count", "3");
+    parser.addOption(threadsOption);
+    parser.addOption(memoryOption);
+    parser.addOption(samplesOption);
+    parser.addOption(seedOption);
+    parser.addOption(worstOption);
+    parser.addPositionalArgument("sizes", "Board sizes, all game sizes by default.");
+    parser.process(app);
+
+    std::vector<uint32_t> sizes;
+    for (const auto& arg : parser.positionalArguments()) {
+        auto size = arg.toUInt();
+        if (size < 2 || size > Board::MaxSize) {
+            fprintf(stderr, "size %s is out of range\n", arg.toLocal8Bit().constData());
+            return 1;
+        }
+        sizes.push_back(size);
+    }
+    if (sizes.empty()) {
+        for (auto size = Board::MinPlaySize; size <= Board::MaxPlaySize; ++size)
+            sizes.push_back(size);
+    }
+
+    ThreadPool pool(parser.value(threadsOption).toUInt());
+    const auto memoryLimit = parser.value(memoryOption).toULongLong() * 1024u * 1024u;
+    const auto worstCount = parser.value(worstOption).toUInt();
+
+    for (auto size : sizes) {
+        if (getExploreMemory(size) <= memoryLimit)
+            printDifficulty(exploreDifficulty(size, worstCount, pool));
+        else
+            printDifficulty(sampleDifficulty(size, parser.value(samplesOption).toULongLong(),
+                parser.value(seedOption).toULongLong(), worstCount, pool));
+    }
+    return 0;
+}
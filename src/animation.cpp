@@ -3,16 +3,29 @@
 #include <cassert>
 #include <QObject>
 
-AnimImage::AnimImage(QImage& sprite, uint32_t framesCount, uint32_t frame,
+Sprite::Sprite(const QImage& image) :
+	size_(image.height()) {
+
+	assert(size_ > 0);
+	const auto framesCount = uint32_t(image.width()) / size_;
+	for (auto i = 0u; i < framesCount; ++i)
+		frames_.push_back(QPixmap::fromImage(image.copy(i * size_, 0, size_, size_)));
+}
+
+const QPixmap& Sprite::getFrame(uint32_t number) const {
+
+	assert(number < frames_.size());
+	return frames_[number];
+}
+
+AnimImage::AnimImage(const Sprite& sprite, uint32_t frame,
 	const std::function<void()>& onClick) :
-    size_(sprite.height()),
-	image_(size_, size_, QImage::Format_ARGB32),
-    sprite_(QPixmap::fromImage(sprite)),
-	framesCount_(framesCount),
+	sprite_(sprite),
+	frame_(frame),
 	onClick_(onClick) {
 
-	setFrame(frame);
-    label_.setFixedSize(size_, size_);
+	label_.setPixmap(sprite_.getFrame(frame_));
+    label_.setFixedSize(sprite_.getSize(), sprite_.getSize());
 	QObject::connect(&label_, &ClickableLabel::clicked, [this]() {
 		this->onClick_();
 	});
@@ -20,14 +33,12 @@ AnimImage::AnimImage(QImage& sprite, uint32_t framesCount, uint32_t frame,
 
 void AnimImage::setFrame(uint32_t number) {
 
-	assert(number < framesCount_);
+	assert(number < sprite_.getFrameCount());
+	if (number == frame_)
+		return;
+	// pixmaps are implicitly shared, the label keeps a reference only
 	frame_ = number;
-	QPainter painter;
-	painter.begin(&image_);
-	painter.eraseRect(0, 0, image_.width(), image_.height());
-    painter.drawImage(0, 0, sprite_.toImage(), size_ * frame_, 0, size_, size_);
-	painter.end();
-	label_.setPixmap(QPixmap::fromImage(image_));
+	label_.setPixmap(sprite_.getFrame(frame_));
 }
 
 Animation::Animation(AnimImage& target, uint32_t delay, uint32_t duration,
@@ -1,30 +1,44 @@
 #pragma once
 #include <memory>
+#include <vector>
 #include <functional>
 
 #include <QLabel>
-#include <QPainter>
+#include <QPixmap>
 #include "clickablelabel.h"
 
+// Square frames of a horizontal sprite strip, cut once and shared by images.
+class Sprite {
+
+public:
+	explicit Sprite(const QImage& image);
+	~Sprite() = default;
+
+	uint32_t getSize() const { return size_; }
+	uint32_t getFrameCount() const { return static_cast<uint32_t>(frames_.size()); }
+	const QPixmap& getFrame(uint32_t number) const;
+
+private:
+	uint32_t size_ = 0;
+	std::vector<QPixmap> frames_;
+};
+
 class AnimImage {
 
 public:
-	AnimImage(QImage& sprite, uint32_t framesCount, uint32_t frame,
+	AnimImage(const Sprite& sprite, uint32_t frame,
 		const std::function<void()>& onClick);
 	~AnimImage() = default;
 
 	void setFrame(uint32_t number);
+	void setOnClick(const std::function<void()>& onClick) { onClick_ = onClick; }
 	uint32_t getFrame() const { return frame_; }
-	uint32_t getFrameCount() const { return framesCount_; }
+	uint32_t getFrameCount() const { return sprite_.getFrameCount(); }
     QLabel* getQLabel() { return &label_; }
 
 private:
-	uint32_t size_ = 0;
-	QImage image_;
-	QPainter painter_;
+	const Sprite& sprite_;
     ClickableLabel label_;
-	QPixmap sprite_;
-	uint32_t framesCount_ = 0;
 	uint32_t frame_ = 0;
 	std::function<void()> onClick_;
 };
@@ -39,6 +53,7 @@ public:
 	~Animation() = default;
 
 	bool update(uint32_t msDelta);
+	void finish() { target_.setFrame(endFrame_); }
 
 private:
 	AnimImage& target_;
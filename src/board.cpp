@@ -0,0 +1,98 @@
+#include "board.h"
+#include "rng.h"
+#include <array>
+#include <cassert>
+
+static uint64_t parity(uint64_t value) {
+
+	value ^= value >> 32;
+	value ^= value >> 16;
+	value ^= value >> 8;
+	value ^= value >> 4;
+	value ^= value >> 2;
+	value ^= value >> 1;
+	return value & 1u;
+}
+
+Board::Board(uint32_t size, uint64_t seed) {
+
+	generate(size, seed);
+}
+
+void Board::generate(uint32_t size, uint64_t seed) {
+
+	assert(size > 0);
+	assert(size <= MaxSize);
+
+	size_ = size;
+	seed_ = seed;
+
+	// A uniform random set of moves applied to the solved board gives a
+	// uniform solvable board; boards with an open lock are drawn again,
+	// which keeps the result uniform among valid starting boards.
+	Rng rng(seed);
+	// moves live on the stack, regenerating a board of the same size
+	// doesn't touch the heap
+	std::array<Row, MaxSize> moves;
+	do {
+		for (auto iy = 0u; iy < size_; ++iy)
+			moves[iy] = rng.next() & getFullRow();
+		rows_.assign(size_, getFullRow());
+		applyMoves(moves.data());
+	} while (getLockedMask() != getFullRow());
+}
+
+void Board::applyMoves(const std::vector<Row>& moves) {
+
+	assert(moves.size() == size_);
+	applyMoves(moves.data());
+}
+
+void Board::applyMoves(const Row* moves) {
+
+	// knob (x, y) flips once per move in row y, once per move in column x,
+	// and the move at (x, y) itself is counted by both
+	Row columns = 0;
+	for (auto iy = 0u; iy < size_; ++iy)
+		columns ^= moves[iy];
+	for (auto iy = 0u; iy < size_; ++iy)
+		rows_[iy] ^= moves[iy] ^ columns ^ (parity(moves[iy]) ? getFullRow() : 0);
+}
+
+void Board::turnKnob(uint32_t x, uint32_t y) {
+
+	assert(x < size_);
+	assert(y < size_);
+
+	// whole row flips, the rest of the column flips bit by bit
+	const auto bit = Row(1) << x;
+	for (auto iy = 0u; iy < size_; ++iy)
+		rows_[iy] ^= bit;
+	rows_[y] ^= getFullRow() ^ bit;
+}
+
+bool Board::isChecked(uint32_t x, uint32_t y) const {
+
+	assert(x < size_);
+	assert(y < size_);
+	return (rows_[y] >> x) & 1u;
+}
+
+bool Board::isLocked(uint32_t x) const {
+
+	assert(x < size_);
+	return (getLockedMask() >> x) & 1u;
+}
+
+Board::Row Board::getLockedMask() const {
+
+	auto unlocked = getFullRow();
+	for (auto row : rows_)
+		unlocked &= row;
+	return getFullRow() & ~unlocked;
+}
+
+Board::Row Board::getFullRow() const {
+
+	return (size_ < 64u) ? ((Row(1) << size_) - 1u) : ~Row(0);
+}
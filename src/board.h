@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Headless puzzle core: knobs state and turn rules without any Qt objects.
+// Knob (x, y) is checked when bit x of row y is set. The lock above column x
+// is open when every knob of that column is checked.
+class Board {
+
+public:
+	static const auto MaxSize = 64u;
+	// Limits of the game itself, shared by the widgets and headless tools.
+	static const auto MinPlaySize = 4u;
+	static const auto MaxPlaySize = 10u;
+	static const auto MinMoveTimeMSec = 250u;
+
+	using Row = uint64_t;
+
+	Board() = default;
+	Board(uint32_t size, uint64_t seed);
+	~Board() = default;
+
+	void generate(uint32_t size, uint64_t seed);
+	void turnKnob(uint32_t x, uint32_t y);
+	// Applies every move whose bit is set in one go, moves[y] bit x is (x, y).
+	void applyMoves(const std::vector<Row>& moves);
+	uint32_t getSize() const { return size_; }
+	uint64_t getSeed() const { return seed_; }
+	bool isChecked(uint32_t x, uint32_t y) const;
+	bool isLocked(uint32_t x) const;
+	Row getLockedMask() const;
+	bool isSolved() const { return getLockedMask() == 0; }
+	const std::vector<Row>& getRows() const { return rows_; }
+
+private:
+	void applyMoves(const Row* moves);
+	Row getFullRow() const;
+
+	uint32_t size_ = 0;
+	uint64_t seed_ = 0;
+	std::vector<Row> rows_;
+};
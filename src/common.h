@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <string>
+#include <chrono>
 
 template <class Type, typename... Args>
 Type* make_qt_owned(Args... args) {
@@ -14,6 +15,22 @@ void delete_qt_forced(Type* obj) {
 	delete obj;
 }
 
+// Milliseconds between ticks, one clock drives every board of a window.
+class FrameClock {
+
+public:
+	uint32_t tick() {
+
+		auto curTime = std::chrono::steady_clock::now();
+		auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(curTime - lastTime_);
+		lastTime_ = curTime;
+		return static_cast<uint32_t>(dt.count());
+	}
+
+private:
+	std::chrono::steady_clock::time_point lastTime_ = std::chrono::steady_clock::now();
+};
+
 inline std::string formatTimeMSec(uint32_t sec) {
 
 	const auto Hour = 60u * 60u;
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -28,19 +28,28 @@ SOURCES += \
     gamewidget.cpp \
     animation.cpp \
     puzzle.cpp \
+    board.cpp \
     scores.cpp \
     clickablelabel.cpp \
-    scoredialog.cpp
+    scoredialog.cpp \
+    spectator.cpp \
+    spectatorwidget.cpp \
+    practicewidget.cpp
 
 HEADERS += \
     gamewidget.h \
     animation.h \
     command.h \
     puzzle.h \
+    board.h \
+    rng.h \
     scores.h \
     clickablelabel.h \
     scoredialog.h \
-    common.h
+    common.h \
+    spectator.h \
+    spectatorwidget.h \
+    practicewidget.h
 
 RESOURCES += \
     game.qrc
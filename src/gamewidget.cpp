@@ -5,6 +5,7 @@
 #include <QGridLayout>
 #include <QPushButton>
 #include <QBoxLayout>
+#include <QSlider>
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QTimer>
@@ -14,8 +15,8 @@
 GameWidget::GameWidget(uint32_t size, QWidget *parent) : QWidget(parent) {
 
     puzzle_ = makePuzzle(size);
-    scores_ = makeScores("scores");
-    scores_->load();
+    scores_ = makeScores("scores", Scores::SyncPolicy::EverySave);
+    scores_->loadAsync();
 
     mainLayout_ = make_qt_owned<QBoxLayout>(QBoxLayout::TopToBottom);
 
@@ -51,7 +52,12 @@ GameWidget::GameWidget(uint32_t size, QWidget *parent) : QWidget(parent) {
     btnLayout->addWidget(scoreBtn);
     btnLayout->addStretch(1);
 
+    history_ = make_qt_owned<QSlider>(Qt::Horizontal, this);
+    history_->setRange(0, 0);
+    connect(history_, &QSlider::valueChanged, [this](int value) { puzzle_->jumpTo(value); });
+
     mainLayout_->addLayout(btnLayout);
+    mainLayout_->addWidget(history_);
     mainLayout_->addLayout(puzzle_->getGrid());
     setLayout(mainLayout_);
     adjustSize();
@@ -62,6 +68,36 @@ GameWidget::GameWidget(uint32_t size, QWidget *parent) : QWidget(parent) {
     timer->start(20);
 }
 
+bool GameWidget::startPublishing(const QString& name) {
+
+    spectators_ = std::make_unique<SpectatorServer>();
+    if (!spectators_->listen(name)) {
+        spectators_ = nullptr;
+        return false;
+    }
+    puzzle_->setActionHandler([this](Puzzle::Action action, uint32_t x, uint32_t y) {
+        switch (action) {
+        case Puzzle::Action::Reset:
+            spectators_->publishReset(puzzle_->getSize(), puzzle_->getSeed());
+            break;
+        case Puzzle::Action::Turn:
+            spectators_->publishTurn(y * puzzle_->getSize() + x);
+            break;
+        case Puzzle::Action::Undo:
+            spectators_->publishUndo();
+            break;
+        case Puzzle::Action::Redo:
+            spectators_->publishRedo();
+            break;
+        case Puzzle::Action::Jump:
+            spectators_->publishJump(x);
+            break;
+        }
+    });
+    spectators_->publishReset(puzzle_->getSize(), puzzle_->getSeed());
+    return true;
+}
+
 void GameWidget::newGame() {
 
 	auto ok = false;
@@ -71,7 +107,6 @@ void GameWidget::newGame() {
 
     if(ok) {
         puzzle_->reset(size);
-        mainLayout_->addLayout(puzzle_->getGrid());
         resize(minimumSizeHint());
 		isFinished_ = false;
     }
@@ -88,13 +123,21 @@ void GameWidget::onTimer() {
 	if (isFinished_) {
 		redoBtn_->setEnabled(false);
 		undoBtn_->setEnabled(false);
+		history_->setEnabled(false);
 		return;
 	}
-	puzzle_->update();
+	puzzle_->update(clock_.tick());
 
 	timer_->setText(QString::fromStdString(formatTimeMSec(puzzle_->getSpentTimeSec())));
 	redoBtn_->setEnabled(puzzle_->hasRedos() && !puzzle_->isBusy());
 	undoBtn_->setEnabled(puzzle_->hasUndos() && !puzzle_->isBusy());
+	{
+		// scrubbing works at any time, animations are cut short
+		QSignalBlocker blocker(history_);
+		history_->setEnabled(true);
+		history_->setRange(0, puzzle_->getHistorySize());
+		history_->setValue(puzzle_->getHistoryPosition());
+	}
 
 	if (puzzle_->isSolved()) {
 		isFinished_ = true;
@@ -106,7 +149,13 @@ void GameWidget::onTimer() {
 
 		if (ok && !text.isEmpty()) {
 			scores_->addRecord(puzzle_->getSpentTimeSec(), text.toStdString().c_str());
-			scores_->save();
+			scores_->saveAsync([this](bool ok) {
+				if (ok)
+					return;
+				QMetaObject::invokeMethod(this, [this]() {
+					QMessageBox::warning(this, tr("Score table"), tr("Can't save the score table."));
+				}, Qt::QueuedConnection);
+			});
 		}
 		showScores();
 	}
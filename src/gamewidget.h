@@ -1,6 +1,8 @@
 #pragma once
 #include "puzzle.h"
 #include "scores.h"
+#include "spectator.h"
+#include "common.h"
 #include <memory>
 #include <stdint.h>
 #include <QWidget>
@@ -10,6 +12,7 @@ class QGridLayout;
 class QBoxLayout;
 class QLineEdit;
 class QPushButton;
+class QSlider;
 
 class GameWidget : public QWidget {
 
@@ -17,13 +20,18 @@ class GameWidget : public QWidget {
 public:
     explicit GameWidget(uint32_t size, QWidget* parent = nullptr);
 
+    bool startPublishing(const QString& name);
+
 private:
 	QBoxLayout* mainLayout_ = nullptr;
 	QLineEdit* timer_ = nullptr;
 	QPushButton* undoBtn_ = nullptr;
 	QPushButton* redoBtn_ = nullptr;
+	QSlider* history_ = nullptr;
 	PuzzlePtr puzzle_ = nullptr;
 	ScoresPtr scores_ = nullptr;
+	std::unique_ptr<SpectatorServer> spectators_ = nullptr;
+	FrameClock clock_;
 	bool isFinished_ = false;
 
 private slots:
@@ -1,13 +1,45 @@
 #include "gamewidget.h"
+#include "spectatorwidget.h"
+#include "practicewidget.h"
 #include "puzzle.h"
+#include <cstdio>
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
     Q_INIT_RESOURCE(game);
 
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption publishOption("publish", "Stream the game to spectators.", "name");
+    QCommandLineOption spectateOption("spectate", "Watch a game streamed by another player.", "name");
+    QCommandLineOption practiceOption("practice", "Solve several boards side by side.", "count");
+    parser.addOption(publishOption);
+    parser.addOption(spectateOption);
+    parser.addOption(practiceOption);
+    parser.process(a);
+
+    if (parser.isSet(spectateOption)) {
+        SpectatorWidget spectator(parser.value(spectateOption));
+        spectator.show();
+        return a.exec();
+    }
+
+    if (parser.isSet(practiceOption)) {
+        const auto count = qBound(1u, parser.value(practiceOption).toUInt(), 64u);
+        PracticeWidget practice(count, Puzzle::MinSize);
+        practice.show();
+        return a.exec();
+    }
+
     GameWidget game(Puzzle::MinSize);
+    if (parser.isSet(publishOption) && !game.startPublishing(parser.value(publishOption))) {
+        fprintf(stderr, "can't publish as %s\n", parser.value(publishOption).toLocal8Bit().constData());
+        return 1;
+    }
 	game.show();
 
     return a.exec();
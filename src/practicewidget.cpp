@@ -0,0 +1,98 @@
+#include "practicewidget.h"
+#include <cmath>
+#include <QGridLayout>
+#include <QBoxLayout>
+#include <QPushButton>
+#include <QInputDialog>
+#include <QLabel>
+#include <QTimer>
+
+PracticeWidget::PracticeWidget(uint32_t boardsCount, uint32_t size, QWidget *parent) :
+    QWidget(parent) {
+
+    auto newGameBtn = make_qt_owned<QPushButton>(tr("new games"), this);
+    connect(newGameBtn, SIGNAL(clicked()), this, SLOT(newGames()));
+    newGameBtn->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+
+    auto btnLayout = make_qt_owned<QBoxLayout>(QBoxLayout::LeftToRight);
+    btnLayout->addWidget(newGameBtn);
+    btnLayout->addStretch(1);
+
+    // boards are laid out in a square-ish table
+    const auto columns = uint32_t(std::ceil(std::sqrt(double(boardsCount))));
+    auto boardsLayout = make_qt_owned<QGridLayout>();
+    boards_.resize(boardsCount);
+    for (auto i = 0u; i < boardsCount; ++i) {
+        auto& board = boards_[i];
+        board.puzzle = makePuzzle(size);
+        board.status = make_qt_owned<QLabel>(this);
+        board.status->setAlignment(Qt::AlignCenter);
+        showStatus(board, true);
+
+        auto boardLayout = make_qt_owned<QBoxLayout>(QBoxLayout::TopToBottom);
+        boardLayout->addWidget(board.status);
+        boardLayout->addLayout(board.puzzle->getGrid());
+        boardsLayout->addLayout(boardLayout, i / columns, i % columns);
+    }
+
+    auto mainLayout = make_qt_owned<QBoxLayout>(QBoxLayout::TopToBottom);
+    mainLayout->addLayout(btnLayout);
+    mainLayout->addLayout(boardsLayout);
+    setLayout(mainLayout);
+    setWindowTitle(tr("Practice"));
+    adjustSize();
+    resize(minimumSizeHint());
+
+    auto timer = make_qt_owned<QTimer>(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(onTimer()));
+    timer->start(20);
+}
+
+void PracticeWidget::newGames() {
+
+	auto ok = false;
+    auto size = QInputDialog::getInt(this, tr("Enter new grid size"),
+		tr("Grid size"), Puzzle::MinSize, Puzzle::MinSize, Puzzle::MaxSize, 1,
+		&ok,  Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+
+    if(ok) {
+        for (auto& board : boards_) {
+            board.puzzle->reset(size);
+            board.puzzle->setReadOnly(false);
+            board.solved = false;
+            showStatus(board, true);
+        }
+        resize(minimumSizeHint());
+    }
+}
+
+void PracticeWidget::onTimer() {
+
+	// All boards step with the same delta inside one slot; labels only mark
+	// dirty regions, so the window is repainted once after the slot returns.
+	const auto msDelta = clock_.tick();
+	for (auto& board : boards_) {
+		// solved boards still finish their last animations
+		if (board.solved && !board.puzzle->isBusy())
+			continue;
+		board.puzzle->update(msDelta);
+		if (board.solved || !board.puzzle->isSolved())
+			showStatus(board, false);
+		else {
+			board.solved = true;
+			board.puzzle->setReadOnly(true);
+			showStatus(board, true);
+		}
+	}
+}
+
+void PracticeWidget::showStatus(PracticeBoard& board, bool force) {
+
+	// text changes relayout the label, so it's touched once a second at most
+	const auto sec = board.puzzle->getSpentTimeSec();
+	if (!force && sec == board.shownSec)
+		return;
+	board.shownSec = sec;
+	auto text = QString::fromStdString(formatTimeMSec(sec));
+	board.status->setText(board.solved ? tr("%1 solved").arg(text) : text);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "puzzle.h"
+#include "common.h"
+#include <vector>
+#include <stdint.h>
+#include <QWidget>
+
+class QLabel;
+
+// Practice session: several boards in one window driven by a single timer.
+class PracticeWidget : public QWidget {
+
+    Q_OBJECT
+public:
+    PracticeWidget(uint32_t boardsCount, uint32_t size, QWidget* parent = nullptr);
+
+private:
+	struct PracticeBoard {
+
+		PuzzlePtr puzzle = nullptr;
+		QLabel* status = nullptr;
+		uint32_t shownSec = 0;
+		bool solved = false;
+	};
+
+	void showStatus(PracticeBoard& board, bool force);
+
+	std::vector<PracticeBoard> boards_;
+	FrameClock clock_;
+
+private slots:
+    void newGames();
+    void onTimer();
+};
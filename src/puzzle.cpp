@@ -2,11 +2,10 @@
 #include "common.h"
 #include "command.h"
 #include "animation.h"
+#include "board.h"
 #include <cassert>
 #include <vector>
 #include <algorithm>
-#include <algorithm>
-#include <random>
 #include <chrono>
 #include <QGridLayout>
 
@@ -15,7 +14,7 @@ using namespace std::chrono;
 using TimePoint = time_point<system_clock>;
 
 static const auto AnimationDelay = 150u;
-static const auto AnimationDuration = 250u;
+static const auto AnimationDuration = Puzzle::MinMoveTimeMSec;
 
 static const auto KnobStartFrame = 0u;
 static const auto KnobMiddleFrame = 6u;
@@ -24,41 +23,60 @@ static const auto KnobEndFrame = 12u;
 static const auto LockStartFrame = 0u;
 static const auto LockEndFrame = 6u;
 
+struct PuzzleSprites {
+
+	Sprite knob{QImage(":/icons/knob.png")};
+	Sprite lock{QImage(":/icons/lock.png")};
+};
+
+// All boards alive at a time share one copy of the sprite frames.
+static std::shared_ptr<const PuzzleSprites> getPuzzleSprites() {
+
+	static std::weak_ptr<const PuzzleSprites> cache;
+	auto sprites = cache.lock();
+	if (!sprites) {
+		sprites = std::make_shared<const PuzzleSprites>();
+		cache = sprites;
+	}
+	return sprites;
+}
+
 class PuzzleImpl : public Puzzle {
 
 public:
     PuzzleImpl(uint32_t size);
 	virtual ~PuzzleImpl() = default;
-	void update() override;
+	void update(uint32_t msDelta) override;
 	void reset(uint32_t size) override;
+	void reset(uint32_t size, uint64_t seed) override;
 	void turnKnob(uint32_t x, uint32_t y) override;
 	void undo() override;
 	void redo() override;
+	void jumpTo(uint32_t position) override;
+	void setHistory(const std::vector<uint32_t>& moves, uint32_t position) override;
+	uint32_t getHistorySize() const override { return uint32_t(undos_.size() + redos_.size()); }
+	uint32_t getHistoryPosition() const override { return uint32_t(undos_.size()); }
     bool hasUndos() const override { return !undos_.empty(); }
     bool hasRedos() const override { return !redos_.empty(); }
     bool isBusy() const override { return !animations_.empty();}
 	bool isSolved() const override;
 	uint32_t getSpentTimeSec() const override;
+	uint32_t getSize() const override { return size_; }
+	uint64_t getSeed() const override { return board_.getSeed(); }
+	void setReadOnly(bool readOnly) override { readOnly_ = readOnly; }
+	void setActionHandler(const ActionHandler& handler) override { handler_ = handler; }
     QGridLayout* getGrid() const override { return grid_.get(); }
 
 private:
+	void notify(Action action, uint32_t x = 0, uint32_t y = 0);
 	void turnKnobAction(uint32_t x, uint32_t y);
-	void updateKnob(uint32_t index, uint32_t delay);
+	void pushParity(uint32_t x, uint32_t y);
+	void showJump();
+	void updateKnob(uint32_t x, uint32_t y, bool checked, uint32_t delay);
 	void updateLock(uint32_t index, uint32_t delay);
-	void generateField();
-	void rebuild();
-
-	struct Knob {
-
-		AnimImagePtr image = nullptr;
-		bool checked = false;
-	};
-
-	struct Lock {
-
-		AnimImagePtr image = nullptr;
-		bool locked = true;
-	};
+	void generateField(uint64_t seed);
+	void rebuild(uint64_t seed);
+	void relayout();
 
 	class TurnKnobCommand : public Command {
 
@@ -77,35 +95,48 @@ private:
 	};
 
     std::unique_ptr<QGridLayout> grid_;
-	QImage knobSprite_;
-	QImage lockSprite_;
+	// owned by grid_ while laid out, reused on every relayout
+	QSpacerItem* spacers_[4] = {};
+	std::shared_ptr<const PuzzleSprites> sprites_;
 	uint32_t size_ = MinSize;
-	std::vector<Lock> locks_;
-	std::vector<Knob> knobs_;
+	uint32_t layoutSize_ = 0;
+	bool readOnly_ = false;
+	ActionHandler handler_;
+	Board board_;
+	// cells pool, grows up to the biggest board and keeps spare cells hidden
+	std::vector<AnimImagePtr> locks_;
+	std::vector<AnimImagePtr> knobs_;
 	std::vector<CommandPtr> undos_;
 	std::vector<CommandPtr> redos_;
+	// parity of the moves done before each history position, size_ rows each
+	std::vector<Board::Row> parities_;
+	std::vector<Board::Row> jumpMoves_;
+	std::vector<Board::Row> jumpRows_;
 	std::vector<AnimationPtr> animations_;
 	TimePoint startTime_ = system_clock::now();
-	TimePoint lastFrameTime_ = system_clock::now();
 	milliseconds spentTime_ = milliseconds::zero();
 };
 
 PuzzleImpl::PuzzleImpl(uint32_t size) :
-    knobSprite_(":/icons/knob.png"),
-	lockSprite_(":/icons/lock.png") {
+    grid_(std::make_unique<QGridLayout>()),
+    sprites_(getPuzzleSprites()) {
+
+    grid_->setSpacing(0);
+    auto sz = sprites_->knob.getSize();
+    spacers_[0] = make_qt_owned<QSpacerItem>(sz, sz * 2, QSizePolicy::Minimum, QSizePolicy::Expanding);
+    spacers_[1] = make_qt_owned<QSpacerItem>(sz, sz * 2, QSizePolicy::Minimum, QSizePolicy::Expanding);
+    spacers_[2] = make_qt_owned<QSpacerItem>(sz * 2, sz, QSizePolicy::Expanding, QSizePolicy::Minimum);
+    spacers_[3] = make_qt_owned<QSpacerItem>(sz * 2, sz, QSizePolicy::Expanding, QSizePolicy::Minimum);
 
 	reset(size);
 }
 
-void PuzzleImpl::update() {
-
-	auto curTime = system_clock::now();
-	auto dt = duration_cast<milliseconds>(curTime - lastFrameTime_);
-	lastFrameTime_ = curTime;
+void PuzzleImpl::update(uint32_t msDelta) {
 
+	const auto dt = milliseconds(msDelta);
 	for (size_t i = 0; i < animations_.size();) {
 		auto& anim = animations_[i];
-		if (anim->update(dt.count())) {
+		if (anim->update(msDelta)) {
 			animations_[i] = std::move(animations_.back());
 			animations_.pop_back();
 		} else {
@@ -118,21 +149,25 @@ void PuzzleImpl::update() {
 
 void PuzzleImpl::reset(uint32_t size) {
 
+	reset(size, system_clock::now().time_since_epoch().count());
+}
+
+void PuzzleImpl::reset(uint32_t size, uint64_t seed) {
+
 	assert(size >= MinSize);
 	assert(size <= MaxSize);
 
 	animations_.clear();
 	undos_.clear();
 	redos_.clear();
-	locks_.clear();
-	knobs_.clear();
 
 	size_ = size;
-	locks_.resize(size_);
-	rebuild();
+	parities_.assign(size_, 0);
+	rebuild(seed);
 
 	startTime_ = system_clock::now();
 	spentTime_ = milliseconds::zero();
+	notify(Action::Reset);
 }
 
 void PuzzleImpl::turnKnob(uint32_t x, uint32_t y) {
@@ -148,6 +183,10 @@ void PuzzleImpl::turnKnob(uint32_t x, uint32_t y) {
 	auto command = std::make_unique<TurnKnobCommand>(*this, x, y);
 	command->doAction();
 	undos_.push_back(std::move(command));
+
+	parities_.resize(undos_.size() * size_);
+	pushParity(x, y);
+	notify(Action::Turn, x, y);
 }
 
 void PuzzleImpl::undo() {
@@ -158,6 +197,7 @@ void PuzzleImpl::undo() {
 	redos_.push_back(std::move(undos_.back()));
 	undos_.pop_back();
 	redos_.back()->undoAction();
+	notify(Action::Undo);
 }
 
 void PuzzleImpl::redo() {
@@ -168,6 +208,88 @@ void PuzzleImpl::redo() {
 	undos_.push_back(std::move(redos_.back()));
 	redos_.pop_back();
 	undos_.back()->doAction();
+	notify(Action::Redo);
+}
+
+void PuzzleImpl::jumpTo(uint32_t position) {
+
+	assert(position <= getHistorySize());
+
+	const auto current = getHistoryPosition();
+	if (position == current)
+		return;
+
+	for (auto& anim : animations_)
+		anim->finish();
+	animations_.clear();
+
+	// every move is its own inverse, so the way between two positions is
+	// the difference of their move parities whatever the order was
+	jumpMoves_.assign(parities_.begin() + current * size_,
+		parities_.begin() + (current + 1) * size_);
+	for (auto iy = 0u; iy < size_; ++iy)
+		jumpMoves_[iy] ^= parities_[position * size_ + iy];
+
+	while (undos_.size() > position) {
+		redos_.push_back(std::move(undos_.back()));
+		undos_.pop_back();
+	}
+	while (undos_.size() < position) {
+		undos_.push_back(std::move(redos_.back()));
+		redos_.pop_back();
+	}
+
+	showJump();
+	notify(Action::Jump, position);
+}
+
+void PuzzleImpl::setHistory(const std::vector<uint32_t>& moves, uint32_t position) {
+
+	assert(position <= moves.size());
+
+	for (auto& anim : animations_)
+		anim->finish();
+	animations_.clear();
+
+	// the board keeps showing the current position until the jump below
+	jumpMoves_.assign(parities_.begin() + getHistoryPosition() * size_,
+		parities_.begin() + (getHistoryPosition() + 1) * size_);
+
+	undos_.clear();
+	redos_.clear();
+	parities_.assign(size_, 0);
+	for (auto move : moves) {
+		assert(move < size_ * size_);
+		pushParity(move % size_, move / size_);
+	}
+	for (auto i = 0u; i < position; ++i)
+		undos_.push_back(std::make_unique<TurnKnobCommand>(*this, moves[i] % size_, moves[i] / size_));
+	// redos_ is a stack, the next move goes on top
+	for (auto i = uint32_t(moves.size()); i > position; --i)
+		redos_.push_back(std::make_unique<TurnKnobCommand>(*this, moves[i - 1] % size_, moves[i - 1] / size_));
+
+	for (auto iy = 0u; iy < size_; ++iy)
+		jumpMoves_[iy] ^= parities_[position * size_ + iy];
+	showJump();
+}
+
+void PuzzleImpl::showJump() {
+
+	jumpRows_ = board_.getRows();
+	const auto lockedMask = board_.getLockedMask();
+	board_.applyMoves(jumpMoves_);
+	for (auto iy = 0u; iy < size_; ++iy) {
+		const auto changed = jumpRows_[iy] ^ board_.getRows()[iy];
+		for (auto ix = 0u; ix < size_; ++ix) {
+			if ((changed >> ix) & 1u)
+				updateKnob(ix, iy, (jumpRows_[iy] >> ix) & 1u, 0);
+		}
+	}
+	const auto changedMask = lockedMask ^ board_.getLockedMask();
+	for (auto ix = 0u; ix < size_; ++ix) {
+		if ((changedMask >> ix) & 1u)
+			updateLock(ix, 0);
+	}
 }
 
 bool PuzzleImpl::isSolved() const {
@@ -175,9 +297,7 @@ bool PuzzleImpl::isSolved() const {
 	if (isBusy())
 		return false;
 
-	return std::find_if(locks_.begin(), locks_.end(), [](const auto& lock) {
-		return lock.locked;
-	}) == locks_.end();
+	return board_.isSolved();
 }
 
 uint32_t PuzzleImpl::getSpentTimeSec() const {
@@ -185,6 +305,22 @@ uint32_t PuzzleImpl::getSpentTimeSec() const {
 	return duration_cast<seconds>(spentTime_).count();
 }
 
+void PuzzleImpl::notify(Action action, uint32_t x, uint32_t y) {
+
+	if (handler_)
+		handler_(action, x, y);
+}
+
+void PuzzleImpl::pushParity(uint32_t x, uint32_t y) {
+
+	// appends the parity of one more move after the last history position
+	const auto last = parities_.size() - size_;
+	for (auto iy = 0u; iy < size_; ++iy) {
+		const auto row = parities_[last + iy];
+		parities_.push_back((iy == y) ? (row ^ (Board::Row(1) << x)) : row);
+	}
+}
+
 static uint32_t difference(uint32_t v0, uint32_t v1) {
 
 	return (v0 > v1) ? (v0 - v1) : (v1 - v0);
@@ -195,126 +331,109 @@ void PuzzleImpl::turnKnobAction(uint32_t x, uint32_t y) {
 	assert(x < size_);
 	assert(y < size_);
 	// start from center knob
-	auto centerIndex = y * size_ + x;
-	updateKnob(centerIndex, 0);
+	updateKnob(x, y, board_.isChecked(x, y), 0);
 	// iterate through current row and column (excluding center element)
 	for (auto i = 0u; i < size_; ++i) {
-		auto horizIndex = y * size_ + i;
-		if (horizIndex != centerIndex)
-			updateKnob(horizIndex, difference(x, i) * AnimationDelay);
-		auto vertIndex = i * size_ + x;
-		if (vertIndex != centerIndex)
-			updateKnob(vertIndex, difference(y, i) * AnimationDelay);
+		if (i != x)
+			updateKnob(i, y, board_.isChecked(i, y), difference(x, i) * AnimationDelay);
+		if (i != y)
+			updateKnob(x, i, board_.isChecked(x, i), difference(y, i) * AnimationDelay);
 	}
 	auto lockDelay = AnimationDelay * (std::max(
 		std::max(difference(x, 0), difference(x, size_ - 1)),
 		std::max(difference(y, 0), difference(y, size_ - 1))) - 1);
-	// check each column and update locks
+	// turn knobs on the board and update changed locks
+	const auto lockedMask = board_.getLockedMask();
+	board_.turnKnob(x, y);
+	const auto changedMask = lockedMask ^ board_.getLockedMask();
 	for (auto ix = 0u; ix < size_; ++ix) {
-		auto unlocked = true;
-		for (auto iy = 0u; iy < size_; ++iy)
-			unlocked = unlocked && knobs_[iy * size_ + ix].checked;
-		auto& lock = locks_[ix];
-		if (lock.locked != (!unlocked))
+		if ((changedMask >> ix) & 1u)
 			updateLock(ix, lockDelay);
 	}
 }
 
-void PuzzleImpl::updateKnob(uint32_t index, uint32_t delay) {
+void PuzzleImpl::updateKnob(uint32_t x, uint32_t y, bool checked, uint32_t delay) {
 
+	auto index = y * size_ + x;
 	assert(index < knobs_.size());
-	auto& knob = knobs_[index];
-	const auto startFrame = knob.checked ? KnobStartFrame : KnobMiddleFrame;
-	const auto endFrame = knob.checked ? KnobMiddleFrame : KnobEndFrame;
+	const auto startFrame = checked ? KnobStartFrame : KnobMiddleFrame;
+	const auto endFrame = checked ? KnobMiddleFrame : KnobEndFrame;
 	animations_.push_back(std::make_unique<Animation>(
-		*knob.image.get(), delay, AnimationDuration, startFrame, endFrame));
-	knob.checked = !knob.checked;
+		*knobs_[index].get(), delay, AnimationDuration, startFrame, endFrame));
 }
 
 void PuzzleImpl::updateLock(uint32_t index, uint32_t delay) {
 
 	assert(index < locks_.size());
-	auto& lock = locks_[index];
-	const auto startFrame = lock.locked ? LockStartFrame : LockEndFrame;
-	const auto endFrame = lock.locked ? LockEndFrame : LockStartFrame;
+	// called after the turn, so the board already holds the new lock state
+	const auto locked = board_.isLocked(index);
+	const auto startFrame = locked ? LockEndFrame : LockStartFrame;
+	const auto endFrame = locked ? LockStartFrame : LockEndFrame;
 	animations_.push_back(std::make_unique<Animation>(
-		*lock.image.get(), delay, AnimationDuration, startFrame, endFrame));
-	lock.locked = !lock.locked;
+		*locks_[index].get(), delay, AnimationDuration, startFrame, endFrame));
 }
 
-void clearLayout(QGridLayout* layout) {
-
-	QLayoutItem* item = nullptr;
+void PuzzleImpl::rebuild(uint64_t seed) {
 
-    while ((item = layout->takeAt(0))) {
-		auto widget = item->widget();
-        if (widget) {
-            widget->hide();
-			delete_qt_forced(widget);
-        } else
-			delete_qt_forced(item);
-    }
+	if (layoutSize_ != size_)
+		relayout();
+	generateField(seed);
 }
 
-void PuzzleImpl::rebuild() {
+void PuzzleImpl::relayout() {
 
-    if(grid_.get())
-        clearLayout(grid_.get());
+	// cells go back to the pool, only their layout items are dropped
+	while (auto item = grid_->takeAt(0)) {
+		if (item->widget())
+			delete_qt_forced(item);
+	}
 
-    grid_ = std::make_unique<QGridLayout>();
-    grid_->setSpacing(0);
+	while (locks_.size() < size_)
+		locks_.push_back(std::make_unique<AnimImage>(sprites_->lock, LockStartFrame, []() {}));
+	while (knobs_.size() < size_ * size_)
+		knobs_.push_back(std::make_unique<AnimImage>(sprites_->knob, KnobStartFrame, []() {}));
 
-	generateField();
-	
-    auto sz = knobSprite_.height();
-    grid_->addItem(make_qt_owned<QSpacerItem>(sz, sz * 2,
-		QSizePolicy::Minimum, QSizePolicy::Expanding), 0, 0, 1, size_ + 2);
-    grid_->addItem(make_qt_owned<QSpacerItem>(sz, sz * 2,
-		QSizePolicy::Minimum, QSizePolicy::Expanding), size_ + 2, 0, 1, size_ + 2);
- 	grid_->addItem(make_qt_owned<QSpacerItem>(sz * 2, sz,
-		QSizePolicy::Expanding, QSizePolicy::Minimum), 1, 0, size_ + 1, 1);
-	grid_->addItem(make_qt_owned<QSpacerItem>(sz * 2, sz,
-		QSizePolicy::Expanding, QSizePolicy::Minimum), 1, size_ + 1, size_ + 1, 1);
+	// labels get a parent widget once the grid is installed, until then
+	// the layout decides about their visibility itself
+	auto setVisible = [](QLabel* label, bool visible) {
+		if (label->parentWidget())
+			label->setVisible(visible);
+	};
+	for (auto ix = 0u; ix < size_; ++ix) {
+		grid_->addWidget(locks_[ix]->getQLabel(), 0 + 1, ix + 1);
+		setVisible(locks_[ix]->getQLabel(), true);
+		for (auto iy = 0u; iy < size_; ++iy) {
+			auto& knob = knobs_[iy * size_ + ix];
+			knob->setOnClick([this, ix, iy]() {
+				if (!this->readOnly_)
+					this->turnKnob(ix, iy);
+			});
+			grid_->addWidget(knob->getQLabel(), iy + 1 + 1, ix + 1);
+			setVisible(knob->getQLabel(), true);
+		}
+	}
+	for (auto i = size_; i < locks_.size(); ++i)
+		setVisible(locks_[i]->getQLabel(), false);
+	for (auto i = size_ * size_; i < knobs_.size(); ++i)
+		setVisible(knobs_[i]->getQLabel(), false);
+
+	grid_->addItem(spacers_[0], 0, 0, 1, size_ + 2);
+	grid_->addItem(spacers_[1], size_ + 2, 0, 1, size_ + 2);
+	grid_->addItem(spacers_[2], 1, 0, size_ + 1, 1);
+	grid_->addItem(spacers_[3], 1, size_ + 1, size_ + 1, 1);
+	layoutSize_ = size_;
 }
 
-void PuzzleImpl::generateField() {
+void PuzzleImpl::generateField(uint64_t seed) {
 
-	auto engine = std::default_random_engine(
-		system_clock::to_time_t(system_clock::now()));
-	const auto distrBool = std::uniform_int_distribution<>(0, 1);
-	const auto distrSize = std::uniform_int_distribution<>(0, size_ - 1);
-	const auto knobSpriteFrames = knobSprite_.width() / knobSprite_.height();
-	const auto lockSpriteFrames = lockSprite_.width() / lockSprite_.height();
-
-	knobs_.resize(size_ * size_);
-	locks_.resize(size_);
+	board_.generate(size_, seed);
 
+	// rebind pooled cells to the new board
 	for (auto ix = 0u; ix < size_; ++ix) {
-		auto& lock = locks_[ix];
-		lock.locked = true;
-		// insert lock
-		lock.image = std::make_unique<AnimImage>(lockSprite_,
-			lockSpriteFrames, LockStartFrame, []() {});
-		grid_->addWidget(lock.image->getQLabel(), 0 + 1, ix + 1);
-		// generate random knobs values
-		auto unlocked = true;
+		locks_[ix]->setFrame(LockStartFrame);
 		for (auto iy = 0u; iy < size_; ++iy) {
-			auto& knob = knobs_[iy * size_ + ix];
-			knob.checked = distrBool(engine);
-			unlocked = unlocked && knob.checked;
-		}
-		// prevent unlocked locks
-		if (unlocked) {
-			auto randIndex = distrSize(engine) * size_ + ix;
-			knobs_[randIndex].checked = !knobs_[randIndex].checked;
-		}
-		// insert knobs
-		for (auto iy = 0u; iy < size_; ++iy) {
-			auto& knob = knobs_[iy * size_ + ix];
-			knob.image = std::make_unique<AnimImage>(knobSprite_, knobSpriteFrames,
-				knob.checked ? KnobStartFrame : KnobMiddleFrame,
-				[this, ix, iy]() { this->turnKnob(ix, iy); });
-			grid_->addWidget(knob.image->getQLabel(), iy + 1 + 1, ix + 1);
+			knobs_[iy * size_ + ix]->setFrame(
+				board_.isChecked(ix, iy) ? KnobStartFrame : KnobMiddleFrame);
 		}
 	}
 }
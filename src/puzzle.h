@@ -1,26 +1,56 @@
 #pragma once
+#include "board.h"
 #include <stdint.h>
 #include <memory>
+#include <functional>
+#include <vector>
 
 class QGridLayout;
 
 class Puzzle {
 
 public:
-	static const auto MinSize = 4u;
-	static const auto MaxSize = 10u;
+	static const auto MinSize = Board::MinPlaySize;
+	static const auto MaxSize = Board::MaxPlaySize;
+	static const auto MinMoveTimeMSec = Board::MinMoveTimeMSec;
+
+	enum class Action {
+
+		Reset,
+		Turn,
+		Undo,
+		Redo,
+		Jump
+	};
+
+	// Called after an action took place. x and y are set for turns,
+	// x holds the new history position for jumps.
+	using ActionHandler = std::function<void(Action action, uint32_t x, uint32_t y)>;
 
     virtual ~Puzzle() = 0 {}
-	virtual void update() = 0;
+	virtual void update(uint32_t msDelta) = 0;
 	virtual void reset(uint32_t size) = 0;
+	virtual void reset(uint32_t size, uint64_t seed) = 0;
 	virtual void turnKnob(uint32_t x, uint32_t y) = 0;
 	virtual void undo() = 0;
 	virtual void redo() = 0;
+	// Moves through the history at once, animating only the knobs which differ.
+	virtual void jumpTo(uint32_t position) = 0;
+	// Replaces the whole history with turns given as y * size + x and shows
+	// the given position, animating only the knobs which differ. Not reported
+	// to the action handler.
+	virtual void setHistory(const std::vector<uint32_t>& moves, uint32_t position) = 0;
+	virtual uint32_t getHistorySize() const = 0;
+	virtual uint32_t getHistoryPosition() const = 0;
 	virtual bool hasUndos() const = 0;
 	virtual bool hasRedos() const = 0;
 	virtual bool isBusy() const = 0;
 	virtual bool isSolved() const = 0;
 	virtual uint32_t getSpentTimeSec() const = 0;
+	virtual uint32_t getSize() const = 0;
+	virtual uint64_t getSeed() const = 0;
+	virtual void setReadOnly(bool readOnly) = 0;
+	virtual void setActionHandler(const ActionHandler& handler) = 0;
 
     virtual QGridLayout* getGrid() const = 0;
 };
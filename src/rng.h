@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+// xoshiro256** generator seeded through splitmix64: small state, 64 random
+// bits per call and the same sequence for the same seed on every platform.
+class Rng {
+
+public:
+	explicit Rng(uint64_t seed) {
+
+		for (auto& word : state_)
+			word = splitMix(seed);
+	}
+
+	uint64_t next() {
+
+		const auto result = rotl(state_[1] * 5u, 7) * 9u;
+		const auto t = state_[1] << 17;
+		state_[2] ^= state_[0];
+		state_[3] ^= state_[1];
+		state_[1] ^= state_[2];
+		state_[0] ^= state_[3];
+		state_[2] ^= t;
+		state_[3] = rotl(state_[3], 45);
+		return result;
+	}
+
+private:
+	static uint64_t rotl(uint64_t value, int shift) {
+
+		return (value << shift) | (value >> (64 - shift));
+	}
+
+	static uint64_t splitMix(uint64_t& seed) {
+
+		auto z = (seed += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t state_[4];
+};
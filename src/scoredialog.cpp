@@ -14,12 +14,15 @@ enum Cols {
 ScoreDialog::ScoreDialog(Scores& scores, QWidget* parent) :
 	QDialog(parent, Qt::WindowTitleHint | Qt::WindowCloseButtonHint) {
 
-    model_ = make_qt_owned<QStandardItemModel>(scores.getRecordsCount(), Cols::Count, this);
+    auto snapshot = scores.getSnapshot();
+    const auto& records = snapshot->records;
+
+    model_ = make_qt_owned<QStandardItemModel>(int(records.size()), Cols::Count, this);
     model_->setHeaderData(Cols::Name, Qt::Horizontal, tr("Name"));
     model_->setHeaderData(Cols::Time, Qt::Horizontal, tr("Time"));
 
-    for(auto i = 0u; i < scores.getRecordsCount(); ++i) {
-       const auto& rec = scores.getRecord(i);
+    for(auto i = 0u; i < records.size(); ++i) {
+       const auto& rec = records[i];
 
 	   auto nameItem = make_qt_owned<QStandardItem>(QString::fromStdString(rec.name));
 	   nameItem->setFlags(Qt::ItemIsEnabled);
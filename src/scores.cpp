@@ -2,29 +2,149 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 #include <cassert>
+#ifdef _WIN32
+#include <io.h>
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 bool operator < (const Scores::Record& left, const Scores::Record& right) {
 
 	return left.seconds < right.seconds;
 }
 
+static bool syncFile(FILE* file) {
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomically puts the written file in place of the old one, with sync
+// the rename itself is made durable as well.
+static bool replaceFile(const std::string& from, const std::string& to, bool sync) {
+
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(),
+		MOVEFILE_REPLACE_EXISTING | (sync ? MOVEFILE_WRITE_THROUGH : 0)) != 0;
+#else
+	if (rename(from.c_str(), to.c_str()) != 0)
+		return false;
+	if (!sync)
+		return true;
+
+	const auto slash = to.rfind('/');
+	const auto dirName = slash == std::string::npos ? std::string(".") :
+		slash == 0 ? std::string("/") : to.substr(0, slash);
+	const auto dir = open(dirName.c_str(), O_RDONLY);
+	if (dir < 0)
+		return false;
+	const auto ok = fsync(dir) == 0;
+	return (close(dir) == 0) && ok;
+#endif
+}
+
 class ScoresImpl : public Scores {
 
 public:
-	ScoresImpl(const char* fileName) : fileName_(fileName) {}
-	virtual ~ScoresImpl() = default;
+	ScoresImpl(const char* fileName, SyncPolicy policy);
+	virtual ~ScoresImpl();
 	void addRecord(uint32_t seconds, const char* name) override;
-	uint32_t getRecordsCount() const override { return records_.size(); }
-	const Record& getRecord(uint32_t index) const override;
+	void addRecords(const Record* records, uint32_t count) override;
+	SnapshotPtr getSnapshot() const override;
 	bool save() override;
 	bool load() override;
+	void saveAsync(const Callback& done) override;
+	void loadAsync(const Callback& done) override;
+	void flush() override;
 
 private:
-	std::vector<Record> records_;
+	bool readFile(std::vector<Record>& records);
+	bool loadMerged();
+	void publish(std::vector<Record> records);
+	void runIO();
+
+	// writers build the next version aside and swap it in, then bump
+	// version_; readers go to snapshot_ only when version_ has moved
+	SnapshotPtr snapshot_;
+	std::atomic<uint64_t> version_{0};
+	const uint64_t id_;
+	std::mutex writeMutex_;
+	std::mutex fileMutex_;
 	std::string fileName_;
+	SyncPolicy policy_ = SyncPolicy::None;
+
+	// requests for the I/O thread, guarded by ioMutex_
+	std::mutex ioMutex_;
+	std::condition_variable ioRequested_;
+	std::condition_variable ioDone_;
+	bool saveRequested_ = false;
+	bool loadRequested_ = false;
+	bool ioBusy_ = false;
+	bool stop_ = false;
+	std::vector<Callback> saveCallbacks_;
+	std::vector<Callback> loadCallbacks_;
+	std::thread io_;
 };
 
+static std::atomic<uint64_t> nextScoresId{1};
+
+ScoresImpl::ScoresImpl(const char* fileName, SyncPolicy policy) :
+	snapshot_(std::make_shared<Snapshot>()),
+	id_(nextScoresId++),
+	fileName_(fileName),
+	policy_(policy) {
+
+	io_ = std::thread([this]() { this->runIO(); });
+}
+
+ScoresImpl::~ScoresImpl() {
+
+	{
+		std::lock_guard<std::mutex> lock(ioMutex_);
+		stop_ = true;
+	}
+	ioRequested_.notify_one();
+	io_.join();
+}
+
+Scores::SnapshotPtr ScoresImpl::getSnapshot() const {
+
+	// std::atomic_load of a shared_ptr takes a lock and all readers would
+	// share one reference counter. Every thread instead keeps its own
+	// reference to the current version: while the table doesn't change a
+	// read is an atomic load of version_ and a thread local counter bump.
+	struct Cached {
+
+		uint64_t owner = 0;
+		uint64_t version = 0;
+		std::shared_ptr<SnapshotPtr> holder;
+	};
+	static thread_local Cached cached;
+
+	const auto version = version_.load(std::memory_order_acquire);
+	if (!cached.holder || cached.owner != id_ || cached.version != version) {
+		auto current = std::atomic_load(&snapshot_);
+		cached.owner = id_;
+		cached.version = current->version;
+		cached.holder = std::make_shared<SnapshotPtr>(std::move(current));
+	}
+	return SnapshotPtr(cached.holder, cached.holder->get());
+}
+
 void ScoresImpl::addRecord(uint32_t seconds, const char* name) {
 
 	assert(seconds > 0);
@@ -33,45 +153,184 @@ void ScoresImpl::addRecord(uint32_t seconds, const char* name) {
 	Record record;
 	record.seconds = seconds;
 	strncpy(record.name, name, MaxNameLength);
-	records_.emplace_back(record);
-	std::sort(records_.begin(), records_.end());
-	records_.resize(std::min(records_.size(), (size_t)MaxRecordsCount));
+	addRecords(&record, 1);
 }
 
-const Scores::Record& ScoresImpl::getRecord(uint32_t index) const {
+void ScoresImpl::addRecords(const Record* records, uint32_t count) {
+
+	assert(records || count == 0);
 
-	assert(index < records_.size());
-	return records_[index];
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	auto current = std::atomic_load(&snapshot_);
+	// skip publishing when nothing from the batch makes it into the table
+	const auto& table = current->records;
+	if (table.size() == MaxRecordsCount && std::none_of(records, records + count,
+		[&table](const auto& record) { return record < table.back(); }))
+		return;
+
+	auto next = table;
+	next.insert(next.end(), records, records + count);
+	publish(std::move(next));
 }
 
 bool ScoresImpl::save() {
 
-	std::ofstream file(fileName_, std::ios::binary);
-	if (!file.is_open())
+	auto snapshot = getSnapshot();
+	const auto& records = snapshot->records;
+
+	// the table is written aside and renamed over the old file, so a crash
+	// or a lost network mount in the middle never leaves a short file;
+	// surviving a power loss as well takes SyncPolicy::EverySave
+	std::lock_guard<std::mutex> lock(fileMutex_);
+	const auto tempName = fileName_ + ".tmp";
+	auto file = fopen(tempName.c_str(), "wb");
+	if (!file)
 		return false;
-	
-	auto count = records_.size();
-	file.write((const char*)&count, sizeof(count));
-	file.write((const char*)&records_[0], records_.size() * sizeof(Record));
-	return true;
+
+	auto count = records.size();
+	auto ok = fwrite(&count, sizeof(count), 1, file) == 1;
+	ok = ok && fwrite(records.data(), sizeof(Record), count, file) == count;
+	ok = ok && fflush(file) == 0;
+	const auto sync = policy_ == SyncPolicy::EverySave;
+	if (ok && sync)
+		ok = syncFile(file);
+	ok = (fclose(file) == 0) && ok;
+	ok = ok && replaceFile(tempName, fileName_, sync);
+	if (!ok)
+		remove(tempName.c_str());
+	return ok;
 }
 
 bool ScoresImpl::load() {
 
+	std::vector<Record> records;
+	if (!readFile(records))
+		return false;
+
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	publish(std::move(records));
+	return true;
+}
+
+bool ScoresImpl::loadMerged() {
+
+	std::vector<Record> records;
+	if (!readFile(records))
+		return false;
+
+	// records added while the load was queued are kept, the ones already
+	// read from the same file before are not doubled
+	const auto less = [](const Record& left, const Record& right) {
+		if (left.seconds != right.seconds)
+			return left.seconds < right.seconds;
+		return strncmp(left.name, right.name, MaxNameLength) < 0;
+	};
+	std::sort(records.begin(), records.end(), less);
+
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	auto current = std::atomic_load(&snapshot_);
+	auto table = current->records;
+	std::sort(table.begin(), table.end(), less);
+
+	std::vector<Record> merged;
+	std::set_union(records.begin(), records.end(), table.begin(), table.end(),
+		std::back_inserter(merged), less);
+	publish(std::move(merged));
+	return true;
+}
+
+bool ScoresImpl::readFile(std::vector<Record>& records) {
+
+	std::lock_guard<std::mutex> lock(fileMutex_);
 	std::ifstream file(fileName_, std::ios::binary);
 	if (!file.is_open())
 		return false;
-	
+
 	size_t count = 0;
 	file.read((char*)&count, sizeof(count));
-	records_.resize(count);
-	if (records_.size() > 0)
-		file.read((char*)&records_[0], records_.size() * sizeof(Record));
-	
-	return true;
+	records.resize(std::min(count, (size_t)MaxRecordsCount));
+	if (records.size() > 0)
+		file.read((char*)records.data(), records.size() * sizeof(Record));
+	return bool(file);
+}
+
+void ScoresImpl::saveAsync(const Callback& done) {
+
+	{
+		std::lock_guard<std::mutex> lock(ioMutex_);
+		saveRequested_ = true;
+		if (done)
+			saveCallbacks_.push_back(done);
+	}
+	ioRequested_.notify_one();
+}
+
+void ScoresImpl::loadAsync(const Callback& done) {
+
+	{
+		std::lock_guard<std::mutex> lock(ioMutex_);
+		loadRequested_ = true;
+		if (done)
+			loadCallbacks_.push_back(done);
+	}
+	ioRequested_.notify_one();
+}
+
+void ScoresImpl::flush() {
+
+	std::unique_lock<std::mutex> lock(ioMutex_);
+	ioDone_.wait(lock, [this]() {
+		return !saveRequested_ && !loadRequested_ && !ioBusy_;
+	});
+}
+
+void ScoresImpl::runIO() {
+
+	std::unique_lock<std::mutex> lock(ioMutex_);
+	while (true) {
+		ioRequested_.wait(lock, [this]() {
+			return stop_ || saveRequested_ || loadRequested_;
+		});
+		if (!saveRequested_ && !loadRequested_)
+			return;
+
+		// load goes first so a save never overwrites records not read yet
+		const auto loading = loadRequested_;
+		std::vector<Callback> callbacks;
+		if (loading) {
+			loadRequested_ = false;
+			callbacks.swap(loadCallbacks_);
+		} else {
+			saveRequested_ = false;
+			callbacks.swap(saveCallbacks_);
+		}
+		ioBusy_ = true;
+		lock.unlock();
+
+		const auto ok = loading ? loadMerged() : save();
+		for (const auto& callback : callbacks)
+			callback(ok);
+
+		lock.lock();
+		ioBusy_ = false;
+		ioDone_.notify_all();
+	}
+}
+
+void ScoresImpl::publish(std::vector<Record> records) {
+
+	std::stable_sort(records.begin(), records.end());
+	records.resize(std::min(records.size(), (size_t)MaxRecordsCount));
+
+	auto next = std::make_shared<Snapshot>();
+	next->version = std::atomic_load(&snapshot_)->version + 1;
+	next->records = std::move(records);
+	const auto version = next->version;
+	std::atomic_store(&snapshot_, SnapshotPtr(std::move(next)));
+	version_.store(version, std::memory_order_release);
 }
 
-ScoresPtr makeScores(const char* fileName) {
+ScoresPtr makeScores(const char* fileName, Scores::SyncPolicy policy) {
 
-	return std::make_unique<ScoresImpl>(fileName);
+	return std::make_unique<ScoresImpl>(fileName, policy);
 }
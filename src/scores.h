@@ -1,6 +1,8 @@
 #pragma once
 #include <stdint.h>
 #include <memory>
+#include <vector>
+#include <functional>
 
 class Scores {
 
@@ -14,14 +16,48 @@ public:
 		char name[MaxNameLength + 1] = {0,};
 	};
 
-	virtual ~Scores() = 0 {};
+	// Immutable table state; readers keep it alive as long as they need it
+	// while writers publish newer versions next to it. Reading an unchanged
+	// table takes no lock, picking up a new version once per thread does.
+	struct Snapshot {
+
+		uint64_t version = 0;
+		std::vector<Record> records;
+	};
+
+	using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+	// Whether every save waits until the file data and its rename reach
+	// the storage. Saves are atomic replaces either way.
+	enum class SyncPolicy {
+
+		None,
+		EverySave
+	};
+
+	// Invoked on the I/O thread when the operation is over.
+	using Callback = std::function<void(bool ok)>;
+
+	virtual ~Scores() = 0;
 	virtual void addRecord(uint32_t seconds, const char* name) = 0;
-	virtual uint32_t getRecordsCount() const = 0;
-	virtual const Record& getRecord(uint32_t index) const = 0;
+	virtual void addRecords(const Record* records, uint32_t count) = 0;
+	virtual SnapshotPtr getSnapshot() const = 0;
 	virtual bool save() = 0;
+	// Replaces the table with the file contents.
 	virtual bool load() = 0;
+	// Queued to the I/O thread. Saves requested while one is waiting are
+	// coalesced into a single write of the newest table.
+	virtual void saveAsync(const Callback& done = nullptr) = 0;
+	// Merges the file into the table, so records added before it completes
+	// survive; records present in both are kept once.
+	virtual void loadAsync(const Callback& done = nullptr) = 0;
+	// Blocks until all queued operations are over.
+	virtual void flush() = 0;
 };
 
+inline Scores::~Scores() {}
+
 using ScoresPtr = std::unique_ptr<Scores>;
 
-ScoresPtr makeScores(const char* fileName);
+ScoresPtr makeScores(const char* fileName,
+	Scores::SyncPolicy policy = Scores::SyncPolicy::None);
@@ -0,0 +1,337 @@
+#include "spectator.h"
+#include "common.h"
+#include "board.h"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+using namespace std::chrono;
+
+static uint32_t writeVarint(uint8_t* buffer, uint64_t value) {
+
+	auto size = 0u;
+	while (value >= 0x80) {
+		buffer[size++] = uint8_t(value) | 0x80;
+		value >>= 7;
+	}
+	buffer[size++] = uint8_t(value);
+	return size;
+}
+
+static bool readVarint(const uint8_t* data, uint32_t size, uint32_t& offset, uint64_t& value) {
+
+	value = 0;
+	for (auto shift = 0u; offset < size && shift < 64; shift += 7) {
+		auto byte = data[offset++];
+		value |= uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+uint32_t encodeMessage(const StreamMessage& message, uint8_t* buffer) {
+
+	auto size = writeVarint(buffer, (uint64_t(message.msDelta) << 3) | message.event);
+	if (message.event == StreamMessage::Turn || message.event == StreamMessage::Jump) {
+		size += writeVarint(buffer + size, message.index);
+	} else if (message.event == StreamMessage::Reset) {
+		size += writeVarint(buffer + size, message.size);
+		size += writeVarint(buffer + size, message.seed);
+	}
+	assert(size <= MaxMessageSize);
+	return size;
+}
+
+uint32_t decodeMessage(const uint8_t* data, uint32_t size, StreamMessage& message) {
+
+	auto offset = 0u;
+	uint64_t header = 0;
+	if (!readVarint(data, size, offset, header))
+		return 0;
+	message.event = StreamMessage::Event(header & 7u);
+	message.msDelta = uint32_t(header >> 3);
+
+	uint64_t value = 0;
+	if (message.event == StreamMessage::Turn || message.event == StreamMessage::Jump) {
+		if (!readVarint(data, size, offset, value))
+			return 0;
+		message.index = uint32_t(value);
+	} else if (message.event == StreamMessage::Reset) {
+		if (!readVarint(data, size, offset, value))
+			return 0;
+		message.size = uint32_t(value);
+		if (!readVarint(data, size, offset, message.seed))
+			return 0;
+	}
+	return offset;
+}
+
+bool StreamState::apply(const StreamMessage& message) {
+
+	switch (message.event) {
+	case StreamMessage::Reset:
+		if (message.size < Board::MinPlaySize || message.size > Board::MaxPlaySize)
+			return false;
+		size = message.size;
+		seed = message.seed;
+		history.clear();
+		position = 0;
+		sessionMSec = 0;
+		return true;
+	case StreamMessage::Turn:
+		if (message.index >= size * size)
+			return false;
+		history.resize(position);
+		history.push_back(message.index);
+		++position;
+		break;
+	case StreamMessage::Undo:
+		position -= position > 0 ? 1 : 0;
+		break;
+	case StreamMessage::Redo:
+		position += position < history.size() ? 1 : 0;
+		break;
+	case StreamMessage::Jump:
+		if (message.index > history.size())
+			return false;
+		position = message.index;
+		break;
+	default:
+		return false;
+	}
+	sessionMSec += message.msDelta;
+	return true;
+}
+
+bool StreamRing::write(const uint8_t* data, uint32_t size) {
+
+	const auto head = head_.load(std::memory_order_relaxed);
+	const auto tail = tail_.load(std::memory_order_acquire);
+	if (Capacity - (head - tail) < size)
+		return false;
+
+	const auto start = head % Capacity;
+	const auto first = std::min(size, Capacity - start);
+	memcpy(buffer_ + start, data, first);
+	memcpy(buffer_, data + first, size - first);
+	head_.store(head + size, std::memory_order_release);
+	return true;
+}
+
+uint32_t StreamRing::getReadSize() const {
+
+	return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+}
+
+void StreamRing::read(uint8_t* data, uint32_t size) {
+
+	const auto tail = tail_.load(std::memory_order_relaxed);
+	assert(size <= head_.load(std::memory_order_acquire) - tail);
+
+	const auto start = tail % Capacity;
+	const auto first = std::min(size, Capacity - start);
+	memcpy(data, buffer_ + start, first);
+	memcpy(data + first, buffer_, size - first);
+	tail_.store(tail + size, std::memory_order_release);
+}
+
+SpectatorHub::SpectatorHub(StreamRing& ring, std::atomic<bool>& scheduled) :
+    ring_(ring),
+    scheduled_(scheduled) {
+}
+
+bool SpectatorHub::listen(const QString& name) {
+
+    if (!server_) {
+        server_ = make_qt_owned<QLocalServer>(this);
+        connect(server_, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    }
+    QLocalServer::removeServer(name);
+    return server_->listen(name);
+}
+
+void SpectatorHub::drain() {
+
+    // cleared first, so messages written meanwhile schedule one more drain
+    scheduled_ = false;
+    auto size = ring_.getReadSize();
+    if (size == 0)
+        return;
+
+    QByteArray chunk(int(size), Qt::Uninitialized);
+    ring_.read((uint8_t*)chunk.data(), size);
+    // one chunk per drain whatever the number of messages; every socket
+    // still copies it into its own write buffer
+    for (auto socket : subscribers_)
+        socket->write(chunk);
+
+    // newcomers get everything since the last reset
+    auto data = (const uint8_t*)chunk.constData();
+    auto resetOffset = -1;
+    StreamMessage message;
+    for (auto offset = 0u; offset < size;) {
+        auto used = decodeMessage(data + offset, size - offset, message);
+        if (used == 0)
+            break;
+        if (message.event == StreamMessage::Reset)
+            resetOffset = int(offset);
+        offset += used;
+    }
+    if (resetOffset >= 0)
+        session_ = chunk.mid(resetOffset);
+    else
+        session_.append(chunk);
+}
+
+void SpectatorHub::close() {
+
+    drain();
+    for (auto socket : subscribers_) {
+        socket->flush();
+        socket->disconnectFromServer();
+    }
+    if (server_)
+        server_->close();
+}
+
+void SpectatorHub::onNewConnection() {
+
+    while (auto socket = server_->nextPendingConnection()) {
+        subscribers_.append(socket);
+        socket->write(session_);
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            subscribers_.removeOne(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+SpectatorServer::SpectatorServer() {
+
+	hub_ = new SpectatorHub(ring_, scheduled_);
+	hub_->moveToThread(&thread_);
+	QObject::connect(&thread_, &QThread::finished, hub_, &QObject::deleteLater);
+	thread_.start();
+}
+
+SpectatorServer::~SpectatorServer() {
+
+	QMetaObject::invokeMethod(hub_, "close", Qt::BlockingQueuedConnection);
+	thread_.quit();
+	thread_.wait();
+}
+
+bool SpectatorServer::listen(const QString& name) {
+
+	auto ok = false;
+	QMetaObject::invokeMethod(hub_, "listen", Qt::BlockingQueuedConnection,
+		Q_RETURN_ARG(bool, ok), Q_ARG(QString, name));
+	return ok;
+}
+
+void SpectatorServer::publishReset(uint32_t size, uint64_t seed) {
+
+	StreamMessage message;
+	message.event = StreamMessage::Reset;
+	message.size = size;
+	message.seed = seed;
+	publish(message);
+}
+
+void SpectatorServer::publishTurn(uint32_t index) {
+
+	StreamMessage message;
+	message.event = StreamMessage::Turn;
+	message.index = index;
+	publish(message);
+}
+
+void SpectatorServer::publishUndo() {
+
+	StreamMessage message;
+	message.event = StreamMessage::Undo;
+	publish(message);
+}
+
+void SpectatorServer::publishRedo() {
+
+	StreamMessage message;
+	message.event = StreamMessage::Redo;
+	publish(message);
+}
+
+void SpectatorServer::publishJump(uint32_t position) {
+
+	StreamMessage message;
+	message.event = StreamMessage::Jump;
+	message.index = position;
+	publish(message);
+}
+
+void SpectatorServer::publish(StreamMessage& message) {
+
+	auto curTime = steady_clock::now();
+	message.msDelta = uint32_t(duration_cast<milliseconds>(curTime - lastTime_).count());
+	lastTime_ = curTime;
+	state_.apply(message);
+
+	if (message.event == StreamMessage::Reset)
+		stalled_ = false;
+	if (stalled_)
+		return;
+
+	// spectators replay moves by index, so after a loss only the whole
+	// game sent again, this message included, brings them back in sync
+	if (resyncPending_) {
+		resync();
+		return;
+	}
+
+	uint8_t buffer[MaxMessageSize];
+	auto size = encodeMessage(message, buffer);
+	if (!ring_.write(buffer, size)) {
+		if (droppedCount_++ == 0)
+			qWarning("Spectator stream is stalled, resending the game when it recovers");
+		resyncPending_ = true;
+		return;
+	}
+	if (!scheduled_.exchange(true))
+		QMetaObject::invokeMethod(hub_, "drain", Qt::QueuedConnection);
+}
+
+void SpectatorServer::resync() {
+
+	// reset, the whole history and a jump back to the current position,
+	// written at once so spectators never see a part of it
+	std::vector<uint8_t> buffer((state_.history.size() + 2) * MaxMessageSize);
+	StreamMessage message;
+	message.event = StreamMessage::Reset;
+	message.size = state_.size;
+	message.seed = state_.seed;
+	auto size = encodeMessage(message, buffer.data());
+	message.event = StreamMessage::Turn;
+	for (auto index : state_.history) {
+		message.index = index;
+		size += encodeMessage(message, buffer.data() + size);
+	}
+	message.event = StreamMessage::Jump;
+	message.index = state_.position;
+	// spectators restart their clock on reset, the jump carries it forward
+	message.msDelta = state_.sessionMSec;
+	size += encodeMessage(message, buffer.data() + size);
+
+	if (size > StreamRing::Capacity) {
+		qWarning("Spectator stream can't resend a game this long, waiting for a new game");
+		resyncPending_ = false;
+		stalled_ = true;
+		return;
+	}
+	if (!ring_.write(buffer.data(), size))
+		return;
+	resyncPending_ = false;
+	if (!scheduled_.exchange(true))
+		QMetaObject::invokeMethod(hub_, "drain", Qt::QueuedConnection);
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QThread>
+
+class QLocalServer;
+class QLocalSocket;
+
+// Spectator stream: every message starts with a varint (msDelta << 3 | event),
+// where msDelta is the time since the previous message. Turns add the knob
+// index, jumps the history position, resets the board size and seed, all
+// varint encoded.
+struct StreamMessage {
+
+	enum Event {
+
+		Reset,
+		Turn,
+		Undo,
+		Redo,
+		Jump
+	};
+
+	Event event = Reset;
+	uint32_t msDelta = 0;
+	uint32_t size = 0;
+	uint64_t seed = 0;
+	uint32_t index = 0;
+};
+
+static const auto MaxMessageSize = 32u;
+
+// Game as seen through the stream, followed by both ends of it.
+struct StreamState {
+
+	uint32_t size = 0;
+	uint64_t seed = 0;
+	// turns as y * size + x
+	std::vector<uint32_t> history;
+	uint32_t position = 0;
+	// player time since the last reset
+	uint32_t sessionMSec = 0;
+
+	// False when the message doesn't fit the game, the state is kept then.
+	bool apply(const StreamMessage& message);
+};
+
+uint32_t encodeMessage(const StreamMessage& message, uint8_t* buffer);
+// Returns consumed bytes count, 0 when the message isn't complete yet.
+uint32_t decodeMessage(const uint8_t* data, uint32_t size, StreamMessage& message);
+
+// Single producer single consumer byte queue between the game and the hub.
+class StreamRing {
+
+public:
+	static const auto Capacity = 1u << 16;
+
+	bool write(const uint8_t* data, uint32_t size);
+	uint32_t getReadSize() const;
+	void read(uint8_t* data, uint32_t size);
+
+private:
+	std::atomic<uint32_t> head_{0};
+	std::atomic<uint32_t> tail_{0};
+	uint8_t buffer_[Capacity];
+};
+
+// Lives on the streaming thread: keeps the session since the last reset
+// and hands every new chunk of it to all subscribers.
+class SpectatorHub : public QObject {
+
+    Q_OBJECT
+public:
+    SpectatorHub(StreamRing& ring, std::atomic<bool>& scheduled);
+    ~SpectatorHub() = default;
+
+public slots:
+    bool listen(const QString& name);
+    void drain();
+    void close();
+
+private slots:
+    void onNewConnection();
+
+private:
+    StreamRing& ring_;
+    std::atomic<bool>& scheduled_;
+    QLocalServer* server_ = nullptr;
+    QList<QLocalSocket*> subscribers_;
+    QByteArray session_;
+};
+
+// Publishes game actions to spectators. Called from the GUI thread, where it
+// only encodes a few bytes into the ring; sockets are served elsewhere.
+class SpectatorServer {
+
+public:
+	SpectatorServer();
+	~SpectatorServer();
+
+	bool listen(const QString& name);
+	void publishReset(uint32_t size, uint64_t seed);
+	void publishTurn(uint32_t index);
+	void publishUndo();
+	void publishRedo();
+	void publishJump(uint32_t position);
+	// Messages lost to a full ring; each loss is followed by a resync.
+	uint32_t getDroppedCount() const { return droppedCount_; }
+
+private:
+	void publish(StreamMessage& message);
+	void resync();
+
+	StreamRing ring_;
+	std::atomic<bool> scheduled_{false};
+	QThread thread_;
+	SpectatorHub* hub_ = nullptr;
+	std::chrono::steady_clock::time_point lastTime_ = std::chrono::steady_clock::now();
+
+	// game as published, replayed whole when a message was dropped
+	StreamState state_;
+	uint32_t droppedCount_ = 0;
+	bool resyncPending_ = false;
+	// the game outgrew the ring, nothing is sent until the next reset
+	bool stalled_ = false;
+};
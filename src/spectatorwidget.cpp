@@ -0,0 +1,112 @@
+#include "spectatorwidget.h"
+#include "common.h"
+#include <QGridLayout>
+#include <QBoxLayout>
+#include <QLineEdit>
+#include <QLabel>
+#include <QLocalSocket>
+#include <QTimer>
+
+SpectatorWidget::SpectatorWidget(const QString& name, QWidget *parent) : QWidget(parent) {
+
+    puzzle_ = makePuzzle();
+    puzzle_->setReadOnly(true);
+
+    mainLayout_ = make_qt_owned<QBoxLayout>(QBoxLayout::TopToBottom);
+
+    timer_ = make_qt_owned<QLineEdit>(tr("timer"), this);
+    timer_->setReadOnly(true);
+	timer_->setAlignment(Qt::AlignCenter);
+    timer_->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+	timer_->setFixedWidth(70);
+
+    auto btnLayout = make_qt_owned<QBoxLayout>(QBoxLayout::LeftToRight);
+    btnLayout->addWidget(make_qt_owned<QLabel>(name, this));
+    btnLayout->addWidget(timer_);
+    btnLayout->addStretch(1);
+
+    mainLayout_->addLayout(btnLayout);
+    mainLayout_->addLayout(puzzle_->getGrid());
+    setLayout(mainLayout_);
+    setWindowTitle(tr("Spectating %1").arg(name));
+    adjustSize();
+    resize(minimumSizeHint());
+
+    socket_ = make_qt_owned<QLocalSocket>(this);
+    connect(socket_, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    socket_->connectToServer(name, QIODevice::ReadOnly);
+
+    auto timer = make_qt_owned<QTimer>(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(onTimer()));
+    timer->start(20);
+}
+
+void SpectatorWidget::onReadyRead() {
+
+    received_.append(socket_->readAll());
+
+    auto data = (const uint8_t*)received_.constData();
+    auto offset = 0u;
+    StreamMessage message;
+    while (auto used = decodeMessage(data + offset, received_.size() - offset, message)) {
+        messages_.push_back(message);
+        offset += used;
+    }
+    received_.remove(0, int(offset));
+}
+
+void SpectatorWidget::onTimer() {
+
+    puzzle_->update(clock_.tick());
+    // a single move is replayed with its animation, a backlog such as the
+    // session sent on connect, a resync or a burst of jumps is folded into
+    // one step, so the view never lags behind the game
+    if (!messages_.empty() && !puzzle_->isBusy()) {
+        if (messages_.size() == 1)
+            apply(messages_.front());
+        else
+            catchUp();
+        messages_.clear();
+    }
+    timer_->setText(QString::fromStdString(formatTimeMSec(state_.sessionMSec / 1000)));
+}
+
+void SpectatorWidget::apply(const StreamMessage& message) {
+
+    if (!state_.apply(message))
+        return;
+
+    switch (message.event) {
+    case StreamMessage::Reset:
+        puzzle_->reset(state_.size, state_.seed);
+        resize(minimumSizeHint());
+        break;
+    case StreamMessage::Turn:
+        puzzle_->turnKnob(message.index % state_.size, message.index / state_.size);
+        break;
+    case StreamMessage::Undo:
+        puzzle_->undo();
+        break;
+    case StreamMessage::Redo:
+        puzzle_->redo();
+        break;
+    case StreamMessage::Jump:
+        puzzle_->jumpTo(state_.position);
+        break;
+    }
+}
+
+void SpectatorWidget::catchUp() {
+
+    auto reset = false;
+    for (const auto& message : messages_)
+        reset = (state_.apply(message) && message.event == StreamMessage::Reset) || reset;
+    if (state_.size == 0)
+        return;
+
+    if (reset) {
+        puzzle_->reset(state_.size, state_.seed);
+        resize(minimumSizeHint());
+    }
+    puzzle_->setHistory(state_.history, state_.position);
+}
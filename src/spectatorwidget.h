@@ -0,0 +1,35 @@
+#pragma once
+#include "puzzle.h"
+#include "spectator.h"
+#include "common.h"
+#include <deque>
+#include <QWidget>
+
+class QBoxLayout;
+class QLineEdit;
+class QLocalSocket;
+
+// Replays a game published by SpectatorServer on its own read-only puzzle.
+class SpectatorWidget : public QWidget {
+
+    Q_OBJECT
+public:
+    explicit SpectatorWidget(const QString& name, QWidget* parent = nullptr);
+
+private:
+    void apply(const StreamMessage& message);
+    void catchUp();
+
+    QBoxLayout* mainLayout_ = nullptr;
+    QLineEdit* timer_ = nullptr;
+    QLocalSocket* socket_ = nullptr;
+    PuzzlePtr puzzle_ = nullptr;
+    QByteArray received_;
+    std::deque<StreamMessage> messages_;
+    FrameClock clock_;
+    StreamState state_;
+
+private slots:
+    void onReadyRead();
+    void onTimer();
+};
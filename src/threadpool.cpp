@@ -0,0 +1,99 @@
+#include "threadpool.h"
+#include <cassert>
+#include <algorithm>
+
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local uint32_t currentWorker = 0;
+
+ThreadPool::ThreadPool(uint32_t threadsCount) {
+
+	if (threadsCount == 0)
+		threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (auto i = 0u; i < threadsCount; ++i)
+		workers_.push_back(std::make_unique<Worker>());
+	for (auto i = 0u; i < threadsCount; ++i)
+		threads_.emplace_back([this, i]() { this->run(i); });
+}
+
+ThreadPool::~ThreadPool() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	wakeUp_.notify_all();
+	for (auto& thread : threads_)
+		thread.join();
+}
+
+void ThreadPool::submit(Task task) {
+
+	assert(task);
+	// tasks spawned by a worker stay local, others are spread round-robin
+	auto index = (currentPool == this) ? currentWorker :
+		next_.fetch_add(1) % static_cast<uint32_t>(workers_.size());
+
+	++pending_;
+	{
+		// counted under the deque lock, so a thief can't take the task
+		// and decrement queued_ before it was incremented
+		auto& worker = *workers_[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(std::move(task));
+		++queued_;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	wakeUp_.notify_one();
+}
+
+void ThreadPool::wait() {
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void ThreadPool::run(uint32_t index) {
+
+	currentPool = this;
+	currentWorker = index;
+
+	Task task;
+	while (true) {
+		if (popTask(index, task)) {
+			task();
+			task = nullptr;
+			if (--pending_ == 0) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				done_.notify_all();
+			}
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		wakeUp_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+		if (stop_ && queued_ == 0)
+			return;
+	}
+}
+
+bool ThreadPool::popTask(uint32_t index, Task& task) {
+
+	const auto count = static_cast<uint32_t>(workers_.size());
+	for (auto i = 0u; i < count; ++i) {
+		auto& worker = *workers_[(index + i) % count];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.tasks.empty())
+			continue;
+		// own deque is used as a stack, victims are robbed from the other end
+		if (i == 0) {
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+		} else {
+			task = std::move(worker.tasks.front());
+			worker.tasks.pop_front();
+		}
+		--queued_;
+		return true;
+	}
+	return false;
+}
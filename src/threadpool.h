@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Work-stealing pool: every worker owns a task deque, pops its own tasks from
+// the back and steals from the front of the other deques when it runs dry.
+class ThreadPool {
+
+public:
+	using Task = std::function<void()>;
+
+	explicit ThreadPool(uint32_t threadsCount = 0);
+	~ThreadPool();
+
+	void submit(Task task);
+	void wait();
+	uint32_t getThreadsCount() const { return static_cast<uint32_t>(threads_.size()); }
+
+private:
+	struct Worker {
+
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void run(uint32_t index);
+	bool popTask(uint32_t index, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable wakeUp_;
+	std::condition_variable done_;
+	std::atomic<uint32_t> queued_{0};
+	std::atomic<uint32_t> pending_{0};
+	std::atomic<uint32_t> next_{0};
+	bool stop_ = false;
+};
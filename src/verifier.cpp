@@ -0,0 +1,127 @@
+#include "verifier.h"
+#include "board.h"
+#include <cstring>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+
+bool parseSubmission(const std::string& line, Submission& submission) {
+
+	std::istringstream stream(line);
+	if (!(stream >> submission.seed >> submission.size >> submission.seconds >> submission.name))
+		return false;
+
+	submission.moves.clear();
+	uint32_t move = 0;
+	while (stream >> move)
+		submission.moves.push_back(move);
+	return stream.eof();
+}
+
+bool verifySubmission(const Submission& submission) {
+
+	const auto size = submission.size;
+	if (size < Board::MinPlaySize || size > Board::MaxPlaySize)
+		return false;
+	if (submission.name.empty() || submission.name.size() > Scores::MaxNameLength)
+		return false;
+	if (submission.moves.empty() || submission.seconds == 0)
+		return false;
+	// every move keeps the board busy with animations for a while
+	if (uint64_t(submission.seconds) * 1000u <
+		uint64_t(submission.moves.size()) * Board::MinMoveTimeMSec)
+		return false;
+
+	Board board(size, submission.seed);
+	for (auto move : submission.moves) {
+		if (move >= size * size)
+			return false;
+		board.turnKnob(move % size, move / size);
+	}
+	return board.isSolved();
+}
+
+Verifier::Verifier(Scores& scores, uint32_t threadsCount) :
+	scores_(scores),
+	pool_(threadsCount) {
+}
+
+void Verifier::verifyLines(std::vector<std::string> lines) {
+
+	if (lines.size() <= BatchSize) {
+		submitBatch(std::move(lines));
+		return;
+	}
+	for (size_t i = 0; i < lines.size(); i += BatchSize) {
+		auto end = std::min(i + BatchSize, lines.size());
+		submitBatch(std::vector<std::string>(
+			std::make_move_iterator(lines.begin() + i),
+			std::make_move_iterator(lines.begin() + end)));
+	}
+}
+
+bool Verifier::verifyFile(const char* fileName) {
+
+	std::ifstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	std::vector<std::string> batch;
+	batch.reserve(BatchSize);
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty())
+			continue;
+		batch.push_back(std::move(line));
+		if (batch.size() == BatchSize) {
+			submitBatch(std::move(batch));
+			batch = std::vector<std::string>();
+			batch.reserve(BatchSize);
+		}
+	}
+	if (!batch.empty())
+		submitBatch(std::move(batch));
+	return true;
+}
+
+Verifier::Stats Verifier::getStats() const {
+
+	Stats stats;
+	stats.accepted = accepted_;
+	stats.rejected = rejected_;
+	return stats;
+}
+
+bool Verifier::saveScores() {
+
+	return scores_.save();
+}
+
+void Verifier::submitBatch(std::vector<std::string> lines) {
+
+	auto batch = std::make_shared<std::vector<std::string>>(std::move(lines));
+	pool_.submit([this, batch]() { this->verifyBatch(*batch); });
+}
+
+void Verifier::verifyBatch(const std::vector<std::string>& lines) {
+
+	std::vector<Scores::Record> accepted;
+	Submission submission;
+	for (const auto& line : lines) {
+		if (!parseSubmission(line, submission) || !verifySubmission(submission))
+			continue;
+		Scores::Record record;
+		record.seconds = submission.seconds;
+		strncpy(record.name, submission.name.c_str(), Scores::MaxNameLength);
+		accepted.push_back(record);
+	}
+	accepted_ += accepted.size();
+	rejected_ += lines.size() - accepted.size();
+
+	// only the best records of a batch can reach the score table
+	auto best = std::min(accepted.size(), size_t(Scores::MaxRecordsCount));
+	std::partial_sort(accepted.begin(), accepted.begin() + best, accepted.end(),
+		[](const auto& left, const auto& right) { return left.seconds < right.seconds; });
+	if (best > 0)
+		scores_.addRecords(accepted.data(), static_cast<uint32_t>(best));
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "scores.h"
+#include "threadpool.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+
+struct Submission {
+
+	uint64_t seed = 0;
+	uint32_t size = 0;
+	uint32_t seconds = 0;
+	std::string name;
+	std::vector<uint32_t> moves;
+};
+
+// One submission per line: "<seed> <size> <seconds> <name> <move>..."
+// where every move is a knob index (y * size + x).
+bool parseSubmission(const std::string& line, Submission& submission);
+bool verifySubmission(const Submission& submission);
+
+class Verifier {
+
+public:
+	static const auto BatchSize = 256u;
+
+	struct Stats {
+
+		uint64_t accepted = 0;
+		uint64_t rejected = 0;
+	};
+
+	explicit Verifier(Scores& scores, uint32_t threadsCount = 0);
+	~Verifier() { wait(); }
+
+	void verifyLines(std::vector<std::string> lines);
+	bool verifyFile(const char* fileName);
+	void wait() { pool_.wait(); }
+	bool saveScores();
+	Stats getStats() const;
+	uint32_t getThreadsCount() const { return pool_.getThreadsCount(); }
+
+private:
+	void submitBatch(std::vector<std::string> lines);
+	void verifyBatch(const std::vector<std::string>& lines);
+
+	Scores& scores_;
+	std::atomic<uint64_t> accepted_{0};
+	std::atomic<uint64_t> rejected_{0};
+	ThreadPool pool_;
+};
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# Headless solution verifier for submitted games
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = verifier
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    verifiermain.cpp \
+    verifier.cpp \
+    verifierserver.cpp \
+    threadpool.cpp \
+    board.cpp \
+    scores.cpp
+
+HEADERS += \
+    verifier.h \
+    verifierserver.h \
+    threadpool.h \
+    board.h \
+    rng.h \
+    scores.h \
+    common.h
@@ -0,0 +1,90 @@
+#include "verifier.h"
+#include "verifierserver.h"
+#include "scores.h"
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+
+using namespace std::chrono;
+
+static void printStats(const Verifier::Stats& stats, double seconds) {
+
+	auto total = stats.accepted + stats.rejected;
+	printf("verified %llu submissions (%llu accepted, %llu rejected) in %.2f s: %.0f per second\n",
+		(unsigned long long)total, (unsigned long long)stats.accepted,
+		(unsigned long long)stats.rejected, seconds, seconds > 0.0 ? total / seconds : 0.0);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless puzzle solution verifier");
+    parser.addHelpOption();
+    QCommandLineOption scoresOption("scores", "Score table file.", "file", "scores");
+    QCommandLineOption threadsOption("threads", "Worker threads count (0 = all cores).", "count", "0");
+    QCommandLineOption listenOption("listen", "Accept submissions on a local socket.", "name");
+    QCommandLineOption syncOption("sync", "Sync every score table write to the storage before replacing the old file.");
+    parser.addOption(scoresOption);
+    parser.addOption(threadsOption);
+    parser.addOption(listenOption);
+    parser.addOption(syncOption);
+    parser.addPositionalArgument("files", "Submission files, one submission per line.");
+    parser.process(app);
+
+    auto scores = makeScores(parser.value(scoresOption).toStdString().c_str(),
+        parser.isSet(syncOption) ? Scores::SyncPolicy::EverySave : Scores::SyncPolicy::None);
+    scores->load();
+    Verifier verifier(*scores.get(), parser.value(threadsOption).toUInt());
+
+    const auto startTime = steady_clock::now();
+    auto elapsed = [startTime]() {
+        return duration_cast<duration<double>>(steady_clock::now() - startTime).count();
+    };
+
+    for (const auto& fileName : parser.positionalArguments()) {
+        if (!verifier.verifyFile(fileName.toLocal8Bit().constData()))
+            fprintf(stderr, "can't open %s\n", fileName.toLocal8Bit().constData());
+    }
+    verifier.wait();
+
+    if (!parser.isSet(listenOption)) {
+        printStats(verifier.getStats(), elapsed());
+        return verifier.saveScores() ? 0 : 1;
+    }
+
+    VerifierServer server(verifier);
+    if (!server.listen(parser.value(listenOption))) {
+        fprintf(stderr, "can't listen on %s\n", parser.value(listenOption).toLocal8Bit().constData());
+        return 1;
+    }
+
+    // the table is written only when it changed, a failed write is retried
+    auto savedVersion = scores->getSnapshot()->version;
+    std::atomic<bool> saveFailed{false};
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, [&]() {
+        printStats(verifier.getStats(), elapsed());
+        const auto version = scores->getSnapshot()->version;
+        if (version == savedVersion && !saveFailed.exchange(false))
+            return;
+        savedVersion = version;
+        scores->saveAsync([&saveFailed](bool ok) {
+            if (!ok) {
+                fprintf(stderr, "can't save scores\n");
+                saveFailed = true;
+            }
+        });
+    });
+    timer.start(1000);
+
+    const auto result = app.exec();
+    // callbacks of queued saves refer to locals of this scope
+    scores->flush();
+    return result;
+}
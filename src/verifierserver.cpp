@@ -0,0 +1,47 @@
+#include "verifierserver.h"
+#include "common.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+
+VerifierServer::VerifierServer(Verifier& verifier, QObject* parent) :
+    QObject(parent),
+    verifier_(verifier) {
+
+    server_ = make_qt_owned<QLocalServer>(this);
+    connect(server_, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+bool VerifierServer::listen(const QString& name) {
+
+    QLocalServer::removeServer(name);
+    return server_->listen(name);
+}
+
+void VerifierServer::onNewConnection() {
+
+    while (auto socket = server_->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readLines(socket, false); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            readLines(socket, true);
+            socket->deleteLater();
+        });
+    }
+}
+
+void VerifierServer::readLines(QLocalSocket* socket, bool finished) {
+
+    std::vector<std::string> lines;
+    while (socket->canReadLine()) {
+        auto line = socket->readLine().trimmed();
+        if (!line.isEmpty())
+            lines.push_back(line.toStdString());
+    }
+    // the last submission may come without a line break
+    if (finished) {
+        auto line = socket->readAll().trimmed();
+        if (!line.isEmpty())
+            lines.push_back(line.toStdString());
+    }
+    if (!lines.empty())
+        verifier_.verifyLines(std::move(lines));
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "verifier.h"
+#include <QObject>
+
+class QLocalServer;
+class QLocalSocket;
+
+// Accepts submissions on a local socket (Unix domain socket or named pipe),
+// one submission per line, and hands them to the verifier in batches.
+class VerifierServer : public QObject {
+
+    Q_OBJECT
+public:
+    VerifierServer(Verifier& verifier, QObject* parent = nullptr);
+    ~VerifierServer() = default;
+
+    bool listen(const QString& name);
+
+private:
+    void readLines(QLocalSocket* socket, bool finished);
+
+    Verifier& verifier_;
+    QLocalServer* server_ = nullptr;
+
+private slots:
+    void onNewConnection();
+};